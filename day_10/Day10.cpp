@@ -1,81 +1,346 @@
 #include "Day10.h"
 
 #include <algorithm>
-#include <deque>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <numeric>
 #include <sstream>
-#include <cassert>
-#include <map>
-#include <numbers>
-#include <cmath>
-#include <set>
+#include <thread>
 
 using namespace std;
 
-// IntCode struct
+// exact direction between two asteroids, (dx, dy) reduced by their gcd
+typedef struct Direction {
+    int dx;
+    int dy;
+} Direction;
+
+// clockwise ordering of directions where up (dy < 0) is first, uses no floating point
+typedef struct ClockwiseLess {
+    // 0 for the half-plane [up, down), 1 for [down, up)
+    static int half(const Direction& d) {
+        return d.dx > 0 || (d.dx == 0 && d.dy < 0) ? 0 : 1;
+    }
+
+    bool operator()(const Direction& a, const Direction& b) const {
+        if (half(a) != half(b)) {
+            return half(a) < half(b);
+        }
+
+        // within the same half-plane the cross product decides (y points down)
+        return static_cast<long>(a.dx) * b.dy - static_cast<long>(a.dy) * b.dx > 0;
+    }
+} ClockwiseLess;
+
+// Asteroid struct
 typedef struct Asteroid {
     int y;
     int x;
-    map<double, set<tuple<double, pair<int, int>>>> angles_extended = {};
 
     // constructor
     Asteroid(const int y, const int x) : y(y), x(x) {}
 
-    // angle to another asteroid where up is angle 0;
-    [[nodiscard]] double angle_to(const Asteroid& b) const {
+    // exact direction to another asteroid
+    [[nodiscard]] Direction direction_to(const Asteroid& b) const {
         assert(b.x != x || b.y != y); // different asteroid
-        const double t = atan2((b.x - x),-(b.y - y)) * (180.0 / numbers::pi);
-        return t < 0 ? t + 360 : t;
+        const int g = gcd(b.x - x, b.y - y);
+        return {(b.x - x) / g, (b.y - y) / g};
     }
 
-    // distance to another asteroid
-    [[nodiscard]] double distance_to(const Asteroid& b) const {
+    // amount of lattice steps along direction_to(b) needed to reach b
+    [[nodiscard]] int steps_to(const Asteroid& b) const {
         assert(b.x != x || b.y != y); // different asteroid
-        return sqrt(pow(b.x - x, 2) + pow(b.y - y, 2));
+        return gcd(b.x - x, b.y - y);
     }
 
-
 } Asteroid;
 
-void Day10::execute(const vector<string>& lines) {
+// Open addressing set of directions that is reused between stations.
+// Clearing is O(1) by bumping a generation stamp, so a full scan does not allocate.
+typedef struct DirectionSet {
+    vector<uint64_t> keys;
+    vector<uint32_t> stamps;
+    uint32_t generation = 1;
+    size_t mask = 0;
 
-    vector<Asteroid> asteroids;
+    // reserve room for at most n directions at a load factor of at most 1/2
+    explicit DirectionSet(const size_t n) {
+        size_t capacity = 16;
+        while (capacity < 2 * n) {
+            capacity <<= 1;
+        }
+        keys.resize(capacity, 0);
+        stamps.resize(capacity, 0);
+        mask = capacity - 1;
+    }
 
-    // index all asteroids
-    for (int y = 0; y < lines.size(); y++) {
-        for (int x = 0; x < lines[0].size(); x++) {
-            if (lines[y][x] == '#') {
-                asteroids.emplace_back(y, x);
+    void clear() {
+        generation++;
+
+        // wrapped around, reset all the stamps once
+        if (generation == 0) {
+            fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+    }
+
+    // insert a direction, returns true if it was not present yet
+    bool insert(const Direction& d) {
+        const uint64_t key = static_cast<uint64_t>(static_cast<uint32_t>(d.dx)) << 32 |
+                             static_cast<uint32_t>(d.dy);
+        size_t slot = (key * 0x9E3779B97F4A7C15ULL) >> 32 & mask;
+
+        while (stamps[slot] == generation) {
+            if (keys[slot] == key) {
+                return false;
             }
+            slot = (slot + 1) & mask;
+        }
+
+        stamps[slot] = generation;
+        keys[slot] = key;
+        return true;
+    }
+} DirectionSet;
+
+// amount of asteroids visible from the station, i.e. the amount of distinct directions.
+// Gives up early (returning 0) once it can no longer reach the bound, ties are still counted.
+size_t visible_from(const Asteroid& station, const vector<Asteroid>& asteroids, DirectionSet& seen,
+                    const atomic<size_t>& bound) {
+    seen.clear();
+    size_t result = 0;
+
+    for (size_t j = 0; j < asteroids.size(); j++) {
+        const Asteroid& b = asteroids[j];
+
+        // every remaining asteroid adds at most one direction
+        if ((j & 63) == 0 && result + (asteroids.size() - j) < bound.load(memory_order_relaxed)) {
+            return 0;
+        }
+
+        if (station.x == b.x && station.y == b.y) {
+            continue;
+        }
+
+        if (seen.insert(station.direction_to(b))) {
+            result++;
+        }
+    }
+
+    return result;
+}
+
+// raise the shared bound to at least value
+void raise_bound(atomic<size_t>& bound, const size_t value) {
+    size_t current = bound.load(memory_order_relaxed);
+    while (current < value && !bound.compare_exchange_weak(current, value, memory_order_relaxed)) {}
+}
+
+// index of the asteroid that sees the most others (lowest index on ties) and its amount of visible asteroids
+pair<size_t, size_t> best_station(const vector<Asteroid>& asteroids) {
+    atomic<size_t> bound = 0;
+
+    // seed the bound with the asteroid closest to the centre, which usually sees a lot
+    long sum_x = 0, sum_y = 0;
+    for (const Asteroid& a : asteroids) {
+        sum_x += a.x;
+        sum_y += a.y;
+    }
+    const long n = static_cast<long>(asteroids.size());
+    const auto centre = min_element(asteroids.begin(), asteroids.end(),
+        [&](const Asteroid& a, const Asteroid& b) {
+            return abs(a.x * n - sum_x) + abs(a.y * n - sum_y) < abs(b.x * n - sum_x) + abs(b.y * n - sum_y);
+        });
+    {
+        DirectionSet seen(asteroids.size());
+        raise_bound(bound, visible_from(*centre, asteroids, seen, bound));
+    }
+
+    const size_t thread_count = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), asteroids.size()));
+    vector<pair<size_t, size_t>> results(thread_count, {0, 0}); // (visible, index) per thread
+    atomic<size_t> next_candidate = 0;
+
+    vector<thread> workers;
+    for (size_t t = 0; t < thread_count; t++) {
+        workers.emplace_back([&, t] {
+            // per thread scratch buffer
+            DirectionSet seen(asteroids.size());
+            auto& [best_visible, best_index] = results[t];
+
+            for (size_t i = next_candidate++; i < asteroids.size(); i = next_candidate++) {
+                const size_t visible = visible_from(asteroids[i], asteroids, seen, bound);
+
+                if (visible > best_visible || (visible == best_visible && visible > 0 && i < best_index)) {
+                    best_visible = visible;
+                    best_index = i;
+                    raise_bound(bound, visible);
+                }
+            }
+        });
+    }
+
+    for (thread& w : workers) {
+        w.join();
+    }
+
+    // reduce to the best station over all threads
+    pair<size_t, size_t> best = {0, 0};
+    for (const auto& [visible, index] : results) {
+        if (visible > best.first || (visible == best.first && index < best.second)) {
+            best = {visible, index};
         }
     }
 
-    // dummy best asteroid
-    Asteroid best_asteroid(0,0);
+    return {best.second, best.first};
+}
 
-    for (Asteroid a : asteroids) {
+// Vaporization order of the giant laser, produced lazily rotation by rotation.
+// Every direction has a bucket of targets sorted closest first, the laser takes one per bucket per rotation.
+typedef struct LaserSweep {
+    vector<vector<pair<int, int>>> buckets; // per direction in clockwise order, (x, y) closest first
+    vector<size_t> rotation_offsets;        // amount of targets vaporized before rotation r starts
+    vector<size_t> active;                  // buckets still holding targets in the current rotation
+    vector<size_t> next_active;             // buckets that still hold targets after the current rotation
+    size_t cursor = 0;                      // position in active
+    size_t rotation = 0;                    // current rotation
+    size_t remaining = 0;                   // targets not yet yielded by next()
+
+    LaserSweep(const Asteroid& station, const vector<Asteroid>& asteroids) {
+        vector<tuple<Direction, int, const Asteroid*>> targets;
         for (const Asteroid& b : asteroids) {
-            if (a.x == b.x && a.y == b.y) {
+            if (station.x == b.x && station.y == b.y) {
                 continue;
             }
+            targets.emplace_back(station.direction_to(b), station.steps_to(b), &b);
+        }
 
-            // keep track of the angles to other asteroids, the distance of those and the coordinates
-            // because these are maps and sets, they are sorted per default.
-            a.angles_extended[a.angle_to(b)].insert({a.distance_to(b), {b.x,b.y}});
+        // clockwise and then closest first
+        sort(targets.begin(), targets.end(), [](const auto& a, const auto& b) {
+            const auto& [da, sa, pa] = a;
+            const auto& [db, sb, pb] = b;
+            if (ClockwiseLess()(da, db) || ClockwiseLess()(db, da)) {
+                return ClockwiseLess()(da, db);
+            }
+            return sa < sb;
+        });
+
+        // split into one bucket per direction
+        for (size_t i = 0; i < targets.size(); i++) {
+            const auto& [d, steps, b] = targets[i];
+            if (i == 0 || get<0>(targets[i - 1]).dx != d.dx || get<0>(targets[i - 1]).dy != d.dy) {
+                buckets.emplace_back();
+            }
+            buckets.back().emplace_back(b->x, b->y);
         }
 
-        // keep track of the best asteroid
-        if (a.angles_extended.size() > best_asteroid.angles_extended.size()) {
-            best_asteroid = a;
+        // buckets alive in rotation r are the ones holding more than r targets
+        size_t max_depth = 0;
+        for (const auto& bucket : buckets) {
+            max_depth = max(max_depth, bucket.size());
+        }
+        vector<size_t> alive(max_depth + 1, 0);
+        for (const auto& bucket : buckets) {
+            alive[bucket.size() - 1]++;
         }
+        for (size_t r = max_depth; r-- > 1;) {
+            alive[r - 1] += alive[r];
+        }
+        rotation_offsets.push_back(0);
+        for (size_t r = 0; r < max_depth; r++) {
+            rotation_offsets.push_back(rotation_offsets.back() + alive[r]);
+        }
+
+        active.resize(buckets.size());
+        iota(active.begin(), active.end(), 0);
+        remaining = targets.size();
     }
 
-    // amount of visible asteroids is the amount of angles listed
-    cout << "Part 1: " << best_asteroid.angles_extended.size() << endl;
+    // total amount of targets
+    [[nodiscard]] size_t size() const {
+        return rotation_offsets.back();
+    }
+
+    [[nodiscard]] bool has_next() const {
+        return remaining > 0;
+    }
+
+    // the next target to be vaporized
+    pair<int, int> next() {
+        assert(has_next());
+
+        // start a new rotation with only the buckets that are not empty yet
+        if (cursor == active.size()) {
+            swap(active, next_active);
+            next_active.clear();
+            cursor = 0;
+            rotation++;
+        }
+
+        const size_t b = active[cursor++];
+        if (buckets[b].size() > rotation + 1) {
+            next_active.push_back(b);
+        }
+
+        remaining--;
+        return buckets[b][rotation];
+    }
+
+    // the k-th (1-based) target to be vaporized, without advancing the sweep
+    [[nodiscard]] pair<int, int> kth(const size_t k) const {
+        assert(k >= 1 && k <= size());
+
+        // the rotation in which it happens and the position within that rotation
+        const size_t r = upper_bound(rotation_offsets.begin(), rotation_offsets.end(), k - 1) -
+                         rotation_offsets.begin() - 1;
+        size_t index = k - 1 - rotation_offsets[r];
+
+        for (const auto& bucket : buckets) {
+            if (bucket.size() > r && index-- == 0) {
+                return bucket[r];
+            }
+        }
+
+        assert(false);
+        return {-1, -1};
+    }
+} LaserSweep;
+
+void Day10::execute(const vector<string>& lines) {
+
+    vector<Asteroid> asteroids;
+
+    // index all asteroids
+    for (int y = 0; y < lines.size(); y++) {
+        for (int x = 0; x < lines[y].size(); x++) {
+            if (lines[y][x] == '#') {
+                asteroids.emplace_back(y, x);
+            }
+        }
+    }
+
+    if (asteroids.empty()) {
+        cerr << "No asteroids in the input" << endl;
+        return;
+    }
+
+    auto [best_index, best_visible] = best_station(asteroids);
+
+    // amount of visible asteroids is the amount of distinct directions
+    cout << "Part 1: " << best_visible << endl;
+
+    // the laser sweep from the best station
+    const LaserSweep sweep(asteroids[best_index], asteroids);
+
+    if (sweep.size() < 200) {
+        cerr << "Less than 200 asteroids to vaporize" << endl;
+        return;
+    }
 
     // fetch the 200th asteroid
-    const auto it = next(best_asteroid.angles_extended.begin(), 199);
-    auto [distance, point] = *it->second.begin();
+    auto [x, y] = sweep.kth(200);
 
-    cout << "Part 2: " << point.first*100 + point.second << endl;
+    cout << "Part 2: " << x*100 + y << endl;
 }
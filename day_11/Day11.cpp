@@ -1,13 +1,16 @@
 #include "Day11.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <deque>
 #include <iostream>
-#include <map>
+#include <memory>
 #include <cassert>
 #include <ostream>
 #include <sstream>
 #include <utility>
-#include <set>
 
 using namespace std;
 
@@ -106,12 +109,149 @@ typedef struct Robot {
 
 } Robot;
 
+// 64x64 block of hull tiles, one bit per tile for the colour and one for painted-at-least-once
+typedef struct HullChunk {
+    array<uint64_t, 64> white = {};
+    array<uint64_t, 64> painted = {};
+} HullChunk;
+
+// Dense hull that grows around the robot, chunks are only allocated once the robot gets there
+typedef struct HullGrid {
+    static constexpr int CHUNK_BITS = 6;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_BITS;
+
+    vector<unique_ptr<HullChunk>> chunks; // directory of chunks, row major
+    int min_cx = 0;                       // chunk coordinates of the top left of the directory
+    int min_cy = 0;
+    int width = 0;                        // size of the directory in chunks
+    int height = 0;
+    size_t painted_count = 0;             // amount of tiles painted at least once
+
+    // cache of the last chunk used, the robot mostly stays within one
+    int last_cx = 0;
+    int last_cy = 0;
+    HullChunk* last = nullptr;
+
+    // chunk for the tile, nullptr if it was never allocated
+    [[nodiscard]] const HullChunk* find_chunk(const int x, const int y) const {
+        const int cx = (x >> CHUNK_BITS) - min_cx;
+        const int cy = (y >> CHUNK_BITS) - min_cy;
+        if (cx < 0 || cy < 0 || cx >= width || cy >= height) {
+            return nullptr;
+        }
+        return chunks[cy * width + cx].get();
+    }
+
+    // chunk for the tile, allocated (and the directory grown) on demand
+    HullChunk& chunk(const int x, const int y) {
+        const int cx = x >> CHUNK_BITS;
+        const int cy = y >> CHUNK_BITS;
+        if (last != nullptr && cx == last_cx && cy == last_cy) {
+            return *last;
+        }
+
+        if (cx < min_cx || cy < min_cy || cx >= min_cx + width || cy >= min_cy + height) {
+            grow(cx, cy);
+        }
+
+        unique_ptr<HullChunk>& slot = chunks[(cy - min_cy) * width + cx - min_cx];
+        if (!slot) {
+            slot = make_unique<HullChunk>();
+        }
+
+        last_cx = cx;
+        last_cy = cy;
+        last = slot.get();
+        return *last;
+    }
+
+    // grow the directory (at least doubling the grown dimension) so that it covers chunk (cx, cy)
+    void grow(const int cx, const int cy) {
+        if (width == 0) {
+            min_cx = cx;
+            min_cy = cy;
+            width = 1;
+            height = 1;
+            chunks.resize(1);
+            return;
+        }
+
+        int new_min_cx = min_cx, new_min_cy = min_cy;
+        int new_width = width, new_height = height;
+
+        if (cx < min_cx) {
+            new_width = max(2 * width, min_cx + width - cx);
+            new_min_cx = min_cx + width - new_width;
+        } else if (cx >= min_cx + width) {
+            new_width = max(2 * width, cx - min_cx + 1);
+        }
+
+        if (cy < min_cy) {
+            new_height = max(2 * height, min_cy + height - cy);
+            new_min_cy = min_cy + height - new_height;
+        } else if (cy >= min_cy + height) {
+            new_height = max(2 * height, cy - min_cy + 1);
+        }
+
+        // move the existing chunks over, only pointers are copied
+        vector<unique_ptr<HullChunk>> grown(static_cast<size_t>(new_width) * new_height);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                grown[(y + min_cy - new_min_cy) * new_width + x + min_cx - new_min_cx] =
+                    std::move(chunks[y * width + x]);
+            }
+        }
+
+        chunks = std::move(grown);
+        min_cx = new_min_cx;
+        min_cy = new_min_cy;
+        width = new_width;
+        height = new_height;
+    }
+
+    [[nodiscard]] bool is_white(const int x, const int y) const {
+        const HullChunk* c = find_chunk(x, y);
+        return c != nullptr && (c->white[y & (CHUNK_SIZE - 1)] >> (x & (CHUNK_SIZE - 1)) & 1);
+    }
+
+    // change the colour of a tile without counting it as painted
+    void set_colour(const int x, const int y, const bool white) {
+        HullChunk& c = chunk(x, y);
+        const uint64_t bit = uint64_t{1} << (x & (CHUNK_SIZE - 1));
+        const int row = y & (CHUNK_SIZE - 1);
+
+        if (white) {
+            c.white[row] |= bit;
+        } else {
+            c.white[row] &= ~bit;
+        }
+    }
+
+    // paint a tile, counting it the first time it gets painted
+    void paint(const int x, const int y, const bool white) {
+        HullChunk& c = chunk(x, y);
+        const uint64_t bit = uint64_t{1} << (x & (CHUNK_SIZE - 1));
+        const int row = y & (CHUNK_SIZE - 1);
+
+        if (!(c.painted[row] & bit)) {
+            c.painted[row] |= bit;
+            painted_count++;
+        }
+
+        if (white) {
+            c.white[row] |= bit;
+        } else {
+            c.white[row] &= ~bit;
+        }
+    }
+} HullGrid;
+
 // other defined functions
-pair<set<pair<int, int>>, set<pair<int, int>>> exec_11(const std::vector<long>& input, bool part_2);
+HullGrid exec_11(const std::vector<long>& input, bool part_2);
 void run_program_11(VM &vm);
 IntCode read_instruction_11(const VM &vm);
 void run_instruction_11(VM &vm, IntCode const &instruction);
-void print_paint(const set<pair<int, int>>& tiles);
+void print_paint(const HullGrid& hull);
 
 // Main function of this file
 void Day11::execute(const std::vector<std::string>& lines) {
@@ -128,46 +268,57 @@ void Day11::execute(const std::vector<std::string>& lines) {
     // end gathering input
 
 
-    auto [all_tiles_1, white_tiles_1] = exec_11(input, false);
-    cout << "Part 1: " << all_tiles_1.size() << endl;
+    const HullGrid hull_1 = exec_11(input, false);
+    cout << "Part 1: " << hull_1.painted_count << endl;
 
-    auto [all_tiles_2, white_tiles_2] = exec_11(input, true);
-    print_paint(white_tiles_2);
+    const HullGrid hull_2 = exec_11(input, true);
+    print_paint(hull_2);
 }
 
-// print a set of coordinates
-void print_paint(const set<pair<int, int>>& tiles) {
+// print the white tiles of the hull
+void print_paint(const HullGrid& hull) {
     int min_x = 0, max_x = 0;
     int min_y = 0, max_y = 0;
 
-    for (auto [x, y] : tiles) {
-        min_x = min(x, min_x);
-        min_y = min(y, min_y);
-        max_x = max(x, max_x);
-        max_y = max(y, max_y);
+    // bounding box of the white tiles, a chunk row at a time
+    for (int cy = 0; cy < hull.height; cy++) {
+        for (int cx = 0; cx < hull.width; cx++) {
+            const HullChunk* c = hull.chunks[cy * hull.width + cx].get();
+            if (c == nullptr) {
+                continue;
+            }
+
+            for (int row = 0; row < HullGrid::CHUNK_SIZE; row++) {
+                if (c->white[row] == 0) {
+                    continue;
+                }
+                const int base_x = (hull.min_cx + cx) * HullGrid::CHUNK_SIZE;
+                const int y = (hull.min_cy + cy) * HullGrid::CHUNK_SIZE + row;
+                min_x = min(base_x + countr_zero(c->white[row]), min_x);
+                max_x = max(base_x + 63 - countl_zero(c->white[row]), max_x);
+                min_y = min(y, min_y);
+                max_y = max(y, max_y);
+            }
+        }
     }
 
     // print only the white tiles
     for (int y = max_y; y >= min_y; y--) {
+        string row;
         for (int x = min_x; x <= max_x; x++) {
-            if (tiles.contains({x, y})) {
-                cout << "#";
-            } else {
-                cout << " ";
-            }
+            row += hull.is_white(x, y) ? '#' : ' ';
         }
-        cout << endl;
+        cout << row << endl;
     }
 }
 
 
-pair<set<pair<int, int>>, set<pair<int, int>>> exec_11(const std::vector<long>& input, bool part_2) {
-    set<pair<int, int>> white_tiles = {};
-    set<pair<int, int>> visited_tiles = {};
+HullGrid exec_11(const std::vector<long>& input, bool part_2) {
+    HullGrid hull;
 
-    // part_2 starts on a white tile
+    // part_2 starts on a white tile, which does not count as painted
     if (part_2) {
-        white_tiles.insert({0,0});
+        hull.set_colour(0, 0, true);
     }
 
     // brains of the robot
@@ -178,14 +329,8 @@ pair<set<pair<int, int>>, set<pair<int, int>>> exec_11(const std::vector<long>&
 
     // keep going until halted
     while (!R.vm.halted) {
-        // provide the input:
-        if (white_tiles.contains({R.x, R.y})) {
-            // white
-            R.vm.inputs.push_back(1);
-        } else {
-            // black
-            R.vm.inputs.push_back(0);
-        }
+        // provide the input: 1 for white, 0 for black
+        R.vm.inputs.push_back(hull.is_white(R.x, R.y) ? 1 : 0);
 
         // Run and get two results back
 
@@ -194,16 +339,14 @@ pair<set<pair<int, int>>, set<pair<int, int>>> exec_11(const std::vector<long>&
         run_program_11(R.vm);
         const long to_turn = R.vm.output;
 
-        // paint the tile
-        visited_tiles.insert({R.x, R.y});
-        if (to_paint == 1) {
-            // if we paint it white, add to white tiles
-            white_tiles.insert({R.x, R.y});
-        } else {
-            // if we paint it black, try to remove from white tiles
-            white_tiles.erase({R.x, R.y});
+        // robot halted without painting anything
+        if (R.vm.halted) {
+            break;
         }
 
+        // paint the tile
+        hull.paint(R.x, R.y, to_paint == 1);
+
         // turn & move
         if (to_turn == 1) {
             R.turn_right();
@@ -213,7 +356,7 @@ pair<set<pair<int, int>>, set<pair<int, int>>> exec_11(const std::vector<long>&
         R.move_forward();
     }
 
-    return {visited_tiles, white_tiles};
+    return hull;
 }
 
 void run_program_11(VM &vm) {
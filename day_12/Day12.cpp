@@ -1,179 +1,238 @@
 #include "Day12.h"
 
 #include <algorithm>
-#include <deque>
+#include <array>
+#include <charconv>
+#include <cstdlib>
 #include <iostream>
-#include <map>
 #include <numeric>
 #include <cassert>
-#include <set>
 #include <sstream>
+#include <string>
+#include <thread>
 
-using namespace std;
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
-struct Moon {
-    int x, y, z;
-    int vx, vy, vz;
+using namespace std;
 
-    Moon(const int x, const int y, const int z)
-            : x(x), y(y), z(z), vx(0), vy(0), vz(0) {}
+// one dimension of the whole galaxy in struct-of-arrays layout,
+// padded to a multiple of 8 moons so that the AVX2 path can work on full lanes
+struct Axis {
+    vector<int> p; // positions
+    vector<int> v; // velocities
+
+    // update all velocities, positive/negative (at most 1) per other moon to compensate for diff.
+    // Only the first n moons pull, the padding lanes are computed but never read.
+    void apply_gravity(const size_t n) {
+#if defined(__AVX2__)
+        for (size_t i = 0; i < p.size(); i += 8) {
+            const __m256i pi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&p[i]));
+            __m256i vi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&v[i]));
+
+            for (size_t j = 0; j < n; j++) {
+                const __m256i pj = _mm256_set1_epi32(p[j]);
+                // compare results are -1 where true, so this adds sign(pj - pi)
+                vi = _mm256_sub_epi32(vi, _mm256_cmpgt_epi32(pj, pi));
+                vi = _mm256_add_epi32(vi, _mm256_cmpgt_epi32(pi, pj));
+            }
 
-    // update current velocity,
-    // positive/negative (at most 1) to compensate for diff
-    // if there is no difference, does not change
-    void apply_gravity(const Moon m2) {
-        vx += max(-1, min(m2.x - x, 1));
-        vy += max(-1, min(m2.y - y, 1));
-        vz += max(-1, min(m2.z - z, 1));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&v[i]), vi);
+        }
+#else
+        // note that we do not skip the moon itself, the difference is then 0
+        for (size_t i = 0; i < n; i++) {
+            int dv = 0;
+            for (size_t j = 0; j < n; j++) {
+                dv += (p[j] > p[i]) - (p[j] < p[i]);
+            }
+            v[i] += dv;
+        }
+#endif
     }
 
     // apply the current velocity
     void apply_velocity() {
-        x += vx;
-        y += vy;
-        z += vz;
-    }
-
-    // return the potential energy of this moon
-    [[nodiscard]] int get_potential_energy() const {
-        return abs(x) + abs(y) + abs(z);
-    }
-
-    // return the kinetic energy of this moon
-    [[nodiscard]] int get_kinetic_energy() const {
-        return abs(vx) + abs(vy) + abs(vz);
+        for (size_t i = 0; i < p.size(); i++) {
+            p[i] += v[i];
+        }
     }
 };
 
 struct Galaxy {
-    vector<Moon> moons;
+    size_t n = 0;            // amount of moons
+    array<Axis, 3> axes = {}; // x, y and z
 
     void add_moon(const int x, const int y, const int z) {
-        moons.emplace_back(x, y, z);
-    }
-
-    // apply the gravity step between all pairs of moons
-    void apply_gravity_all() {
-        // note that we do not skip duplicates, but since all coordinates
-        // are then the same, velocity does not change.
-        for (Moon& m1 : moons) {
-            for (const Moon& m2 : moons) {
-                m1.apply_gravity(m2);
+        // grow the padding by a full lane when needed
+        if (n == axes[0].p.size()) {
+            for (Axis& a : axes) {
+                a.p.resize(n + 8, 0);
+                a.v.resize(n + 8, 0);
             }
         }
-    }
 
-    // apply the velocity to all moons
-    void apply_velocity_all() {
-        for (Moon& m : moons) {
-            m.apply_velocity();
-        }
+        axes[0].p[n] = x;
+        axes[1].p[n] = y;
+        axes[2].p[n] = z;
+        n++;
     }
 
     // do one step for the entire galaxy
     void do_step() {
-        apply_gravity_all();
-        apply_velocity_all();
+        for (Axis& a : axes) {
+            a.apply_gravity(n);
+            a.apply_velocity();
+        }
     }
 
     // print for debugging purposes
     void print_galaxy() const {
-        for (const Moon m : moons) {
-            cout << "pos=<x=" << m.x << ", y=" <<
-                m.y << ", z=" << m.z << ">, vel=<x=" <<
-                m.vx << ", y=" << m.vy << ", z=" << m.vz << ">" << endl;
+        for (size_t i = 0; i < n; i++) {
+            cout << "pos=<x=" << axes[0].p[i] << ", y=" <<
+                axes[1].p[i] << ", z=" << axes[2].p[i] << ">, vel=<x=" <<
+                axes[0].v[i] << ", y=" << axes[1].v[i] << ", z=" << axes[2].v[i] << ">" << endl;
         }
         cout << endl;
     }
 
+    [[nodiscard]] bool is_initial(const Axis& axis, const int d) const {
+        return equal(axis.p.begin(), axis.p.begin() + n, axes[d].p.begin()) &&
+               equal(axis.v.begin(), axis.v.begin() + n, axes[d].v.begin());
+    }
+
+    // one axis after t steps. Simulates at most min(t, period) steps and skips the full periods once the
+    // axis is back at its initial state, the period itself is never needed up front.
+    [[nodiscard]] Axis axis_at(const int d, const long t) const {
+        Axis axis = axes[d];
+
+        for (long step = 1; step <= t; step++) {
+            axis.apply_gravity(n);
+            axis.apply_velocity();
+
+            if (step < t && is_initial(axis, d)) {
+                return axis_at(d, t % step);
+            }
+        }
+
+        return axis;
+    }
+
+    // total energy after t steps, every axis is simulated on its own thread
+    [[nodiscard]] long get_energy_at(const long t) const {
+        Galaxy result = *this;
+        vector<thread> workers;
+
+        for (int d = 0; d < 3; d++) {
+            workers.emplace_back([this, d, t, &result] {
+                result.axes[d] = axis_at(d, t);
+            });
+        }
+
+        for (thread& w : workers) {
+            w.join();
+        }
+
+        return result.get_total_energy();
+    }
+
     // get the total energy from this system
-    [[nodiscard]] int get_total_energy() const {
-        int result = 0;
+    [[nodiscard]] long get_total_energy() const {
+        long result = 0;
 
-        for (Moon m : moons) {
-            result += m.get_kinetic_energy()*m.get_potential_energy();
+        for (size_t i = 0; i < n; i++) {
+            const long potential = abs(axes[0].p[i]) + abs(axes[1].p[i]) + abs(axes[2].p[i]);
+            const long kinetic = abs(axes[0].v[i]) + abs(axes[1].v[i]) + abs(axes[2].v[i]);
+            result += potential * kinetic;
         }
 
         return result;
     }
 
-    // return a hash of the d-dimension of this galaxy (since independence)
-    [[nodiscard]] vector<int> get_signature(const int d) const {
-        vector<int> result;
-        switch (d) {
-            case 0:
-                for (const auto & m : moons) {
-                    result.emplace_back(m.x);
-                    result.emplace_back(m.vx);
-                }
-                break;
-            case 1:
-                for (const auto & m : moons) {
-                    result.emplace_back(m.y);
-                    result.emplace_back(m.vy);
-                }
-                break;
-            case 2:
-                for (const auto & m : moons) {
-                    result.emplace_back(m.z);
-                    result.emplace_back(m.vz);
-                }
-                break;
-            default:
-                assert(false);
+    // steps until every axis returns to its initial state, one thread per axis (since independence)
+    [[nodiscard]] array<long, 3> get_periods() const {
+        array<long, 3> result = {0, 0, 0};
+        vector<thread> workers;
+
+        for (int d = 0; d < 3; d++) {
+            workers.emplace_back([this, d, &result] {
+                result[d] = axis_period(axes[d], n);
+            });
+        }
+
+        for (thread& w : workers) {
+            w.join();
         }
 
         return result;
     }
 
-};
+    // the step function is reversible, so the first repeated state of an axis is its initial state.
+    // Comparing against that one state keeps memory constant, one copy of the axis is all it takes.
+    static long axis_period(const Axis& initial, const size_t n) {
+        Axis axis = initial;
+        long steps = 0;
 
-void Day12::execute(const vector<string>& lines) {
+        do {
+            axis.apply_gravity(n);
+            axis.apply_velocity();
+            steps++;
+        } while (!equal(axis.p.begin(), axis.p.begin() + n, initial.p.begin()) ||
+                 !equal(axis.v.begin(), axis.v.begin() + n, initial.v.begin()));
 
-    // manually added the moons because of small input
-    auto galaxy = Galaxy();
-    galaxy.add_moon(-16, 15, -9);
-    galaxy.add_moon(-14, 5, 4);
-    galaxy.add_moon(2, 0, 6);
-    galaxy.add_moon(-3, 18, 9);
+        return steps;
+    }
 
-    // part 2 repetition finder
-    vector<set<vector<int>>> axis_signatures = {{}, {}, {}};
-    vector moon_signatures_steps = {0,0,0};
+};
 
-    int steps = 0;
-    while (true) {
-        galaxy.do_step();
-        steps++;
+// read the moons from lines like <x=-1, y=0, z=2>, blank lines are skipped
+Galaxy parse_galaxy(const vector<string>& lines) {
+    Galaxy galaxy;
 
-        if (steps == 1000) {
-            cout << "Part 1: " << galaxy.get_total_energy() << endl;
+    for (const string& line : lines) {
+        if (line.find_first_not_of(" \t\r") == string::npos) {
+            continue;
         }
 
-        // loop until repetition
-        for (int i = 0; i < 3; i++) {
-            // do not do dimensions we already have
-            if (moon_signatures_steps[i] > 0) {
-                continue;
+        // every coordinate is the number right after its name
+        array<int, 3> position{};
+        bool valid = true;
+        for (size_t axis = 0; axis < position.size(); axis++) {
+            const size_t at = line.find(string(1, static_cast<char>('x' + axis)) + "=");
+            if (at == string::npos) {
+                valid = false;
+                break;
             }
 
-            // check if we repeat
-            if (axis_signatures[i].contains(galaxy.get_signature(i))) {
-                moon_signatures_steps[i] = steps;
-            } else {
-                axis_signatures[i].insert(galaxy.get_signature(i));
-            }
+            const char* begin = line.data() + at + 2;
+            const auto [end, error] = from_chars(begin, line.data() + line.size(), position[axis]);
+            valid &= error == errc() && end != begin;
         }
 
-        // found steps until repetition
-        if (moon_signatures_steps[0] > 0 && moon_signatures_steps[1] > 0 &&
-            moon_signatures_steps[2] > 0) {
-            break;
+        if (!valid) {
+            cerr << "Skipping malformed moon: " << line << endl;
+            continue;
         }
+
+        galaxy.add_moon(position[0], position[1], position[2]);
+    }
+
+    return galaxy;
+}
+
+void Day12::execute(const vector<string>& lines) {
+
+    auto galaxy = parse_galaxy(lines);
+
+    if (galaxy.n == 0) {
+        cerr << "No moons in the input" << endl;
+        return;
     }
 
-    cout << "Part 2: " << lcm(lcm(static_cast<long>(moon_signatures_steps[1]),
-        static_cast<long>(moon_signatures_steps[0])),
-        static_cast<long>(moon_signatures_steps[2])) << endl;
+    cout << "Part 1: " << galaxy.get_energy_at(1000) << endl;
 
-}
\ No newline at end of file
+    // periodicity of every axis, the whole galaxy repeats once all axes line up again
+    const array<long, 3> periods = galaxy.get_periods();
+    cout << "Part 2: " << lcm(lcm(periods[0], periods[1]), periods[2]) << endl;
+}
@@ -1,10 +1,16 @@
 #include "Day13.h"
 
 #include <algorithm>
+#include <array>
+#include <deque>
 #include <iostream>
 #include <set>
 #include <cassert>
+#include <chrono>
+#include <cstdlib>
 #include <sstream>
+#include <string>
+#include <thread>
 using namespace std;
 
 // OpCode int
@@ -74,60 +80,161 @@ typedef struct Tile {
 
 // The Arcade
 typedef struct Arcade {
-    vector<vector<TileID>> tiles;
+    vector<TileID> tiles; // row major with stride columns, at least doubles whenever it grows
+    int stride = 0;
+    int rows = 0;
+    int width = 0;        // extent drawn by the game so far
+    int height = 0;
+    int blocks = 0;       // amount of BLOCK tiles currently on the board
     long score;
 
+    // renderer state, only tiles changed since the last frame are drawn again
+    vector<bool> dirty;
+    vector<pair<int, int>> dirty_tiles;
+    bool full_redraw = true;
+    long drawn_score = -1;
+    int max_fps = 0; // 0 means uncapped
+
+    static constexpr int MAX_EXTENT = 4096; // the board never grows past this many tiles per side
+    chrono::steady_clock::time_point last_frame = {};
+
     VM vm; // IntCode computer
 
-    explicit Arcade(VM vm) : score(0), vm(std::move(vm)) {
-        tiles.resize(23, vector<TileID>(43, 0));
-    }
+    explicit Arcade(VM vm) : score(0), vm(std::move(vm)) {}
 
     [[nodiscard]] int part_1() const {
-        int result = 0;
+        return blocks;
+    }
 
-        for (size_t y = 0; y < 23; y++) {
-            for (size_t x = 0; x < 43; x++) {
-                result = tiles[y][x] == BLOCK ? result + 1 : result;
-            }
+    [[nodiscard]] TileID tile(const int x, const int y) const {
+        return tiles[static_cast<size_t>(y) * stride + x];
+    }
+
+    // Grow the storage so that (x, y) fits, at least doubling every side that is too small (up to MAX_EXTENT)
+    // so that a game drawing row by row only reallocates a few times. This forces a full redraw.
+    void grow(const int x, const int y) {
+        int new_stride = max(stride, 16), new_rows = max(rows, 16);
+        while (new_stride <= x) {
+            new_stride = min(MAX_EXTENT, 2 * new_stride);
+        }
+        while (new_rows <= y) {
+            new_rows = min(MAX_EXTENT, 2 * new_rows);
+        }
+
+        vector<TileID> grown(static_cast<size_t>(new_stride) * new_rows, EMPTY);
+        for (int row = 0; row < height; row++) {
+            copy_n(tiles.begin() + static_cast<long>(row) * stride, width,
+                   grown.begin() + static_cast<long>(row) * new_stride);
+        }
+
+        tiles = std::move(grown);
+        stride = new_stride;
+        rows = new_rows;
+
+        dirty.assign(tiles.size(), false);
+        dirty_tiles.clear();
+        full_redraw = true;
+    }
+
+    // change a tile and remember it for the next frame
+    void set_tile(const long x, const long y, const TileID id) {
+        if (x < 0 || y < 0 || x >= MAX_EXTENT || y >= MAX_EXTENT) {
+            cerr << "Tile out of range: " << x << "," << y << endl;
+            return;
         }
 
-        return result;
+        if (x >= stride || y >= rows) {
+            grow(static_cast<int>(x), static_cast<int>(y));
+        }
+        // the cells the extent gains are empty and still blank on the screen, only the tile itself is drawn
+        width = max(width, static_cast<int>(x) + 1);
+        height = max(height, static_cast<int>(y) + 1);
+
+        const size_t index = static_cast<size_t>(y) * stride + x;
+        const TileID old = tiles[index];
+        if (old == id) {
+            return;
+        }
+
+        blocks += (id == BLOCK) - (old == BLOCK);
+        tiles[index] = id;
+
+        if (!full_redraw && !dirty[index]) {
+            dirty[index] = true;
+            dirty_tiles.emplace_back(x, y);
+        }
+    }
+
+    static char tile_char(const TileID id) {
+        switch (id) {
+            case EMPTY:
+                return ' ';
+            case WALL:
+                return '#';
+            case BLOCK:
+                return 'B';
+            case PADDLE:
+                return 'P';
+            case BALL:
+                return 'O';
+            default:
+                assert(false);
+                return '?';
+        }
     }
 
-    void draw_screen() const {
-        cout << "Score: " << score << endl;
-        for (size_t y = 0; y < 23; y++) {
-            for (size_t x = 0; x < 43; x++) {
-                switch (tiles[y][x]) {
-                    case EMPTY:
-                        cout << ' ';
-                        break;
-                    case WALL:
-                        cout << '#';
-                        break;
-                    case BLOCK:
-                        cout << 'B';
-                        break;
-                    case PADDLE:
-                        cout << 'P';
-                        break;
-                    case BALL:
-                        cout << 'O';
-                        break;
-                    default:
-                        assert(false);
+    // Draw a frame: the first one in full, after that only ANSI cursor moves plus the changed cells.
+    // The frame is written at once and, with max_fps set, not sooner than 1/max_fps after the last one.
+    void draw_screen() {
+        if (max_fps > 0) {
+            this_thread::sleep_until(last_frame + chrono::microseconds(1000000 / max_fps));
+        }
+
+        string frame;
+
+        if (full_redraw) {
+            // clear the screen, the board starts on the second row
+            frame += "\x1b[2J\x1b[2;1H";
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    frame += tile_char(tile(x, y));
                 }
+                frame += '\n';
+            }
+            drawn_score = -1;
+        } else {
+            for (const auto& [x, y] : dirty_tiles) {
+                frame += "\x1b[" + to_string(y + 2) + ";" + to_string(x + 1) + "H";
+                frame += tile_char(tile(x, y));
             }
-            cout << endl;
         }
+
+        if (score != drawn_score) {
+            frame += "\x1b[1;1HScore: " + to_string(score) + "\x1b[K";
+            drawn_score = score;
+        }
+
+        // park the cursor below the board
+        frame += "\x1b[" + to_string(height + 2) + ";1H";
+
+        cout.write(frame.data(), static_cast<streamsize>(frame.size()));
+        cout.flush();
+
+        for (const auto& [x, y] : dirty_tiles) {
+            dirty[static_cast<size_t>(y) * stride + x] = false;
+        }
+        dirty_tiles.clear();
+        full_redraw = false;
+        last_frame = chrono::steady_clock::now();
     }
 
 } Arcade;
 
 // other defined functions
 Arcade exec_13(const std::vector<long>& input);
-void run_program_13(VM &vm);
+void play_13(Arcade &A, bool autoplay, bool render);
+bool needs_input_13(const VM &vm);
+bool run_program_13(VM &vm);
 IntCode read_instruction_13(const VM &vm);
 void run_instruction_13(VM &vm, IntCode const &instruction);
 
@@ -149,38 +256,66 @@ void Day13::execute(const std::vector<std::string>& lines) {
     auto A = exec_13(input);
     cout << "Part 1: " << A.part_1() << endl;
 
+    // insert coins and let the host play, set AOC_RENDER to watch it and AOC_FPS to cap the frame rate
+    A.vm = VM('A', input);
     A.vm.tape[0] = 2;
-    A.vm.halted = false;
-
-    // 42-22
-    A.draw_screen();
-
-    while (true) {
-        // collect input
-        int j;
-        cin >> j;
-        A.vm.inputs.push_back(j);
-
-        while (!A.vm.halted) {
-            // Run and get three results back
-
-            run_program_13(A.vm);
-            const long x = A.vm.output;
-            run_program_13(A.vm);
-            const long y = A.vm.output;
-            run_program_13(A.vm);
-            const long id = A.vm.output;
-
-            // process output
-            if (x == -1) {
-                A.score = id;
+    if (getenv("AOC_FPS") != nullptr) {
+        A.max_fps = max(0, atoi(getenv("AOC_FPS")));
+    }
+    play_13(A, true, getenv("AOC_RENDER") != nullptr);
+
+    cout << "Part 2: " << A.score << endl;
+}
+
+// Play the game until it halts. Autoplay follows the ball with the paddle, otherwise the joystick is read from cin.
+// Rendering draws a frame whenever the game needs input, interactive play always renders.
+void play_13(Arcade &A, const bool autoplay, const bool render) {
+    long ball_x = 0;
+    long paddle_x = 0;
+
+    // outputs come in triples of x, y and id
+    array<long, 3> triple = {};
+    int filled = 0;
+
+    while (!A.vm.halted) {
+        if (run_program_13(A.vm)) {
+            triple[filled++] = A.vm.output;
+        } else if (needs_input_13(A.vm)) {
+            // the game wants the joystick
+            if (render || !autoplay) {
+                A.draw_screen();
+            }
+
+            if (autoplay) {
+                A.vm.inputs.push_back(ball_x > paddle_x ? 1 : ball_x < paddle_x ? -1 : 0);
             } else {
-                A.tiles[y][x] = static_cast<TileID>(id);
+                int j;
+                if (!(cin >> j)) {
+                    return;
+                }
+                A.vm.inputs.push_back(j);
             }
+            continue;
+        }
 
+        if (filled < 3) {
+            continue;
         }
+        filled = 0;
 
-        A.draw_screen();
+        // process output
+        const auto [x, y, id] = triple;
+        if (x == -1 && y == 0) {
+            A.score = id;
+            continue;
+        }
+
+        A.set_tile(x, y, static_cast<TileID>(id));
+        if (id == BALL) {
+            ball_x = x;
+        } else if (id == PADDLE) {
+            paddle_x = x;
+        }
     }
 }
 
@@ -196,29 +331,48 @@ Arcade exec_13(const std::vector<long>& input) {
     while (!A.vm.halted) {
         // Run and get three results back
 
-        run_program_13(A.vm);
+        // part 1 does not play, stop once the game halts or asks for the joystick
+        if (!run_program_13(A.vm)) {
+            break;
+        }
         const long x = A.vm.output;
-        run_program_13(A.vm);
+        if (!run_program_13(A.vm)) {
+            break;
+        }
         const long y = A.vm.output;
-        run_program_13(A.vm);
+        if (!run_program_13(A.vm)) {
+            break;
+        }
         const long id = A.vm.output;
 
-       A.tiles[y][x] = static_cast<TileID>(id);
+        A.set_tile(x, y, static_cast<TileID>(id));
     }
 
     return A;
 }
 
-void run_program_13(VM &vm) {
+// whether the next instruction is an input while no input is queued
+bool needs_input_13(const VM &vm) {
+    return !vm.halted && vm.tape[vm.pc] % 100 == INPUT && vm.inputs.empty();
+}
+
+// runs until an output, input starvation or halt, returns whether it stopped on an output
+bool run_program_13(VM &vm) {
     // if this does not run anymore
     if (vm.halted) {
-        return;
+        return false;
     }
 
     vm.paused = false;
 
     // whilst we can do operations
     while (vm.pc < vm.tape.size()) {
+        // pause until the host provides input
+        if (needs_input_13(vm)) {
+            vm.paused = true;
+            return false;
+        }
+
         // fetch and run the instruction
         IntCode instruction = read_instruction_13(vm);
 
@@ -231,6 +385,8 @@ void run_program_13(VM &vm) {
         }
 
     }
+
+    return vm.paused && !vm.halted;
 }
 
 // converts 5-digit number to array
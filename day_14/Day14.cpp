@@ -3,91 +3,264 @@
 #include <algorithm>
 #include <iostream>
 #include <map>
-#include <regex>
-#include <cassert>
-#include <set>
 #include <sstream>
-#include <valarray>
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <string>
+#include <string_view>
 
 using namespace std;
 
-void Day14::execute(const vector<string>& lines) {
+// In-memory trace of a derivation, off by default. When disabled nothing gets formatted,
+// when enabled the lines are buffered and can be dumped in one go afterwards.
+typedef struct TraceSink {
+    bool enabled = false;
+    ostringstream buffer;
 
-    vector<pair<pair<int, string>, vector<pair<int, string>>>> reactions;
+    template <typename... Args>
+    void log(const Args&... args) {
+        if (enabled) {
+            (buffer << ... << args) << '\n';
+        }
+    }
 
-    for (const string& line : lines) {
-        //for every line
+    void dump(ostream& out) const {
+        out << buffer.str();
+        out.flush();
+    }
+} TraceSink;
 
-        // take the right part (originally left size)
-        string right = line.substr(0, line.find("=>"));
-        // and the left side (always size 1)
-        string left = line.substr(line.find("=>") + 3);
+// one reaction, indexed by the interned id of the chemical it produces
+typedef struct Reaction {
+    long amount = 0;                 // amount produced, 0 if there is no reaction for this chemical
+    vector<pair<long, int>> inputs;  // amount and chemical id of every ingredient
+} Reaction;
 
-        // one left side item, strip of spaces and split on space
-        left = std::regex_replace(left, std::regex("^ +| +$|( ) +"), "$1");
-        pair left_processed = {stoi(left.substr(0, left.find(' '))), left.substr(left.find(' ') + 1) };
+// the reaction graph over interned chemical ids
+typedef struct NanoFactory {
+    map<string, int, less<>> ids;
+    vector<string> names;
+    vector<Reaction> reactions;
+    vector<int> order;               // products before their ingredients, ORE last
 
+    // id of a chemical, assigned on first sight (the only time its name is copied)
+    int intern(const string_view name) {
+        if (const auto it = ids.find(name); it != ids.end()) {
+            return it->second;
+        }
 
-        // right side may consist of more items
-        stringstream ssr(right);
-        string interim_result;
-        vector<pair<int, string>> right_processed;
+        const int id = static_cast<int>(names.size());
+        ids.emplace(name, id);
+        names.emplace_back(name);
+        reactions.emplace_back();
+        return id;
+    }
 
-        // process the right side
-        while (getline(ssr, interim_result, ',')) {
-            // remove leading and trailing spaces'
-            interim_result = std::regex_replace(interim_result, std::regex("^ +| +$|( ) +"), "$1");
+    // parse a line like "7 A, 1 E => 1 FUEL" in a single pass, returns false if it is malformed
+    bool add_reaction(const string_view line) {
+        Reaction reaction;
+        size_t i = 0;
+        bool product = false;
 
-            int amount = stoi(interim_result.substr(0, interim_result.find(' ')));
-            string type = interim_result.substr(interim_result.find(' ') + 1);
-            right_processed.emplace_back(amount, type);
-        }
+        const auto skip_spaces = [&] {
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) {
+                i++;
+            }
+        };
 
-        reactions.emplace_back(left_processed, right_processed);
-    }
+        while (true) {
+            // amount
+            skip_spaces();
+            if (i == line.size() || line[i] < '0' || line[i] > '9') {
+                return false;
+            }
+            long amount = 0;
+            while (i < line.size() && line[i] >= '0' && line[i] <= '9') {
+                if (__builtin_mul_overflow(amount, 10, &amount) ||
+                    __builtin_add_overflow(amount, line[i++] - '0', &amount)) {
+                    return false;
+                }
+            }
 
-    //
-    // DONE INPUT PROCESSING
-    //
+            // chemical
+            skip_spaces();
+            const size_t start = i;
+            while (i < line.size() && line[i] >= 'A' && line[i] <= 'Z') {
+                i++;
+            }
+            if (i == start) {
+                return false;
+            }
+            const int id = intern(line.substr(start, i - start));
 
-    deque<pair<int, string>> needed = {{1, "FUEL"}};
+            skip_spaces();
+            if (product) {
+                if (i != line.size()) {
+                    return false;
+                }
+                reaction.amount = amount;
+                reactions[id] = std::move(reaction);
+                return true;
+            }
 
-    int part_1 = 0;
+            reaction.inputs.emplace_back(amount, id);
 
-    while (!needed.empty()) {
-        auto [mnt, type] = needed.front(); needed.pop_front();
-        cout << "TAKING: " << mnt << " * " << type << endl;
+            // separator, either another ingredient or the product follows
+            if (i < line.size() && line[i] == ',') {
+                i++;
+            } else if (line.substr(i, 2) == "=>") {
+                i += 2;
+                product = true;
+            } else {
+                return false;
+            }
+        }
+    }
 
-        // ore we just count, that is what we need
-        if (type == "ORE") {
-            cout << "FILLING: " << mnt << endl;
-            part_1 += mnt;
-            continue;
+    // reverse post order of a depth first search from FUEL, so every chemical comes after all that consume it
+    void sort_topologically() {
+        order.clear();
+        vector<char> state(names.size(), 0); // 0 unseen, 1 on the stack, 2 done
+        vector<pair<int, size_t>> stack = {{intern("FUEL"), 0}};
+        stack.reserve(names.size()); // references into the stack stay valid
+        state[stack.back().first] = 1;
+
+        while (!stack.empty()) {
+            auto& [id, next_input] = stack.back();
+
+            if (next_input < reactions[id].inputs.size()) {
+                const int input = reactions[id].inputs[next_input++].second;
+                assert(state[input] != 1); // the recipes should not contain cycles
+                if (state[input] == 0) {
+                    state[input] = 1;
+                    stack.emplace_back(input, 0);
+                }
+                continue;
+            }
+
+            state[id] = 2;
+            order.push_back(id);
+            stack.pop_back();
         }
 
-        for (const auto&[a, b] : reactions) {
-            if (a.second != type) {
+        reverse(order.begin(), order.end());
+    }
+
+    // ORE needed for the amount of FUEL, saturating at LONG_MAX instead of overflowing.
+    // Every chemical is settled once, after all of its consumers, so the surplus of a reaction is exact
+    // and never has to be re-queued.
+    [[nodiscard]] long ore_for_fuel(const long fuel, TraceSink* trace = nullptr) const {
+        vector<long> needed(names.size(), 0);
+        needed[ids.at("FUEL")] = fuel;
+
+        for (const int id : order) {
+            if (reactions[id].amount == 0 || needed[id] == 0) {
                 continue;
             }
 
-            int complete_times = mnt / a.first;
-            int left_times = mnt % a.first;
+            if (trace) {
+                trace->log("TAKING: ", needed[id], " * ", names[id]);
+            }
+            const long times = needed[id] / reactions[id].amount + (needed[id] % reactions[id].amount != 0);
 
-            if (complete_times > 0) {
-                for (const auto&[b_instance_amount, b_instance_type] : b) {
-                    cout << "NEEDING: " << b_instance_amount * complete_times << " * " << b_instance_type << endl;
-                    needed.emplace_back(b_instance_amount * complete_times, b_instance_type);
+            for (const auto& [amount, input] : reactions[id].inputs) {
+                long total;
+                if (__builtin_mul_overflow(amount, times, &total) ||
+                    __builtin_add_overflow(needed[input], total, &needed[input])) {
+                    return LONG_MAX;
+                }
+
+                if (trace) {
+                    trace->log("NEEDING: ", total, " * ", names[input]);
                 }
             }
+        }
 
-            if (left_times > 0) {
-                needed.emplace_back(left_times, type);
+        const long ore = needed[ids.at("ORE")];
+        if (trace) {
+            trace->log("FILLING: ", ore);
+        }
+        return ore;
+    }
+
+    // most FUEL that can be made from the ORE budget. Since ore_for_fuel(n) <= n * ore_for_fuel(1), the
+    // budget divided by the cost of one FUEL is reachable; gallop up from there and binary search the rest.
+    // LONG_MAX if FUEL does not need any ORE.
+    [[nodiscard]] long max_fuel(const long ore_budget) const {
+        const long ore_per_fuel = ore_for_fuel(1);
+        if (ore_per_fuel == 0) {
+            return LONG_MAX;
+        }
+        // also covers a single FUEL saturating at LONG_MAX
+        if (ore_per_fuel > ore_budget) {
+            return 0;
+        }
+
+        long lo = ore_budget / ore_per_fuel; // reachable
+        if (lo == 0) {
+            return 0;
+        }
+
+        long step = 1;
+        long hi = lo + step; // first amount found to be out of reach
+        while (ore_for_fuel(hi) <= ore_budget) {
+            lo = hi;
+            step = step > LONG_MAX / 4 ? step : step * 2;
+            hi = hi > LONG_MAX - step ? LONG_MAX : hi + step;
+        }
+
+        while (hi - lo > 1) {
+            const long mid = lo + (hi - lo) / 2;
+            if (ore_for_fuel(mid) <= ore_budget) {
+                lo = mid;
+            } else {
+                hi = mid;
             }
+        }
 
+        return lo;
+    }
+} NanoFactory;
+
+void Day14::execute(const vector<string>& lines) {
+
+    NanoFactory factory;
+
+    for (const string& line : lines) {
+        if (line.find_first_not_of(" \t\r") == string::npos) {
+            continue;
+        }
+
+        if (!factory.add_reaction(line)) {
+            cerr << "Malformed reaction: " << line << endl;
+            return;
         }
     }
 
+    //
+    // DONE INPUT PROCESSING
+    //
+
+    if (!factory.ids.contains("FUEL") || !factory.ids.contains("ORE")) {
+        cerr << "The reactions should contain FUEL and ORE" << endl;
+        return;
+    }
+
+    factory.sort_topologically();
 
+    // set AOC_TRACE to dump the derivation of part 1
+    TraceSink trace;
+    trace.enabled = getenv("AOC_TRACE") != nullptr;
 
+    const long part_1 = factory.ore_for_fuel(1, &trace);
+    trace.dump(cerr);
     cout << "Part 1: " << part_1 << endl;
+
+    const long part_2 = factory.max_fuel(1000000000000);
+    if (part_2 == LONG_MAX) {
+        cerr << "FUEL does not need any ORE, there is no limit" << endl;
+        return;
+    }
+    cout << "Part 2: " << part_2 << endl;
 }
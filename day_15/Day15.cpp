@@ -1,17 +1,547 @@
 #include "Day15.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
 #include <deque>
 #include <iostream>
-#include <limits.h>
-#include <map>
 #include <ostream>
 #include <sstream>
-#include <queue>
-#include <set>
+#include <thread>
+#include <utility>
 
 using namespace std;
 
+// OpCode int
+typedef int OpCode;
+constexpr OpCode ADD = 1;
+constexpr OpCode MULT = 2;
+constexpr OpCode INPUT = 3;
+constexpr OpCode OUTPUT = 4;
+constexpr OpCode JUMP_TRUE = 5;
+constexpr OpCode JUMP_FALSE = 6;
+constexpr OpCode LESS_THAN = 7;
+constexpr OpCode EQUALS = 8;
+constexpr OpCode RELATIVE_ADJUST = 9;
+constexpr OpCode END = 99;
+
+// ParameterMode int
+typedef int ParameterMode;
+constexpr ParameterMode POSITION = 0;
+constexpr ParameterMode IMMEDIATE = 1;
+constexpr ParameterMode RELATIVE = 2;
+
+// IntCode struct
+typedef struct IntCode {
+    long modes_n_opcode;     // The full int of the instruction
+    OpCode op_code;         // after deconstruction, the op_code
+    ParameterMode mode_a;   // after deconstruction, the mode of a
+    ParameterMode mode_b;   // after deconstruction, the mode of b
+    ParameterMode mode_c;   // after deconstruction, the mode of c
+    long a;                  // argument 1
+    long b;                  // argument 2
+    long c;                  // argument 3
+    int offset;             // offset depending on the opcode
+} IntCode;
+
+// VM struct
+typedef struct VM {
+    char tag;                   // identifier
+    size_t pc;                  // program counter
+    std::vector<long> tape;      // the program to work on
+    std::deque<long> inputs;     // the inputs given to the machine
+    long output;                 // an output of the machine
+    bool halted;                // halted or not
+    bool paused;                // paused or not
+    long relative_offset;
+
+    // constructor
+    VM(const char t, std::vector<long> program)
+        : tag(t), pc(0), tape(std::move(program)), output(0), halted(false), paused(false), relative_offset(0) {
+        tape.resize(tape.size() + 10000, 0); // add additional zeros for day 9
+    }
+} VM;
+
+
+// movement commands of the repair droid
+typedef int Move;
+constexpr Move NORTH = 1;
+constexpr Move SOUTH = 2;
+constexpr Move WEST = 3;
+constexpr Move EAST = 4;
+
+// status codes of the repair droid
+constexpr long HIT_WALL = 0;
+constexpr long MOVED = 1;
+constexpr long FOUND_OXYGEN = 2;
+
+// cells of the maze
+typedef char Cell;
+constexpr Cell UNKNOWN = 0;
+constexpr Cell WALL = 1;
+constexpr Cell OPEN = 2;
+constexpr Cell OXYGEN = 3;
+constexpr Cell PROBING = 4; // scheduled to be probed in the current BFS level
+
+// Dense maze around the start, grows (doubling) whenever a cell outside of it gets explored
+typedef struct Maze {
+    int min_x = -32;
+    int min_y = -32;
+    int width = 64;
+    int height = 64;
+    vector<Cell> cells = vector<Cell>(64 * 64, UNKNOWN);
+
+    [[nodiscard]] bool contains(const int x, const int y) const {
+        return x >= min_x && y >= min_y && x < min_x + width && y < min_y + height;
+    }
+
+    [[nodiscard]] Cell get(const int x, const int y) const {
+        return contains(x, y) ? cells[(y - min_y) * width + x - min_x] : UNKNOWN;
+    }
+
+    void set(const int x, const int y, const Cell c) {
+        while (!contains(x, y)) {
+            grow();
+        }
+        cells[(y - min_y) * width + x - min_x] = c;
+    }
+
+    // double both dimensions, keeping the current cells centered
+    void grow() {
+        vector<Cell> grown(static_cast<size_t>(4) * width * height, UNKNOWN);
+        for (int y = 0; y < height; y++) {
+            copy_n(cells.begin() + static_cast<long>(y) * width, width,
+                   grown.begin() + static_cast<long>(y + height / 2) * 2 * width + width / 2);
+        }
+
+        cells = std::move(grown);
+        min_x -= width / 2;
+        min_y -= height / 2;
+        width *= 2;
+        height *= 2;
+    }
+} Maze;
+
+// a reachable position together with the state of the droid standing there
+typedef struct DroidState {
+    int x;
+    int y;
+    VM vm;
+} DroidState;
+
+// the result of trying one move from a known state
+typedef struct Probe {
+    size_t from;     // index in the frontier
+    Move move;
+    int x;           // target position
+    int y;
+    long status = HIT_WALL;
+    VM vm;           // droid state after the move
+} Probe;
+
+// other defined functions
+pair<Maze, int> explore_15(const std::vector<long>& input);
+int fill_time_15(const Maze& maze, const vector<pair<int, int>>& sources);
+bool needs_input_15(const VM &vm);
+bool run_program_15(VM &vm);
+IntCode read_instruction_15(const VM &vm);
+void run_instruction_15(VM &vm, IntCode const &instruction);
+
+// Main function of this file
 void Day15::execute(const vector<string>& lines) {
+    // gathering input and putting it into an array
+    vector<long> input;
+
+    stringstream ss(lines.front());
+    string interim_result;
+
+    while (getline(ss, interim_result, ',')) {
+        input.push_back(stol(interim_result));
+    }
+    // end gathering input
+
+    auto [maze, oxygen_distance] = explore_15(input);
+
+    if (oxygen_distance < 0) {
+        cerr << "The oxygen system was not found" << endl;
+        return;
+    }
+
+    cout << "Part 1: " << oxygen_distance << endl;
+
+    // the oxygen spreads from the oxygen system(s)
+    vector<pair<int, int>> sources;
+    for (int y = maze.min_y; y < maze.min_y + maze.height; y++) {
+        for (int x = maze.min_x; x < maze.min_x + maze.width; x++) {
+            if (maze.get(x, y) == OXYGEN) {
+                sources.emplace_back(x, y);
+            }
+        }
+    }
+
+    cout << "Part 2: " << fill_time_15(maze, sources) << endl;
+}
+
+// Map the whole maze by BFS over cloned droid states instead of walking the droid back and forth.
+// Every level tries all unknown neighbours of the frontier, those probes are independent and run on
+// all cores. Returns the maze and the amount of moves to the oxygen system (-1 if not found).
+pair<Maze, int> explore_15(const std::vector<long>& input) {
+    constexpr array<Move, 4> moves = {NORTH, SOUTH, WEST, EAST};
+    constexpr array<int, 4> dx = {0, 0, -1, 1};
+    constexpr array<int, 4> dy = {-1, 1, 0, 0};
+
+    Maze maze;
+    maze.set(0, 0, OPEN);
+
+    vector<DroidState> frontier;
+    frontier.push_back({0, 0, VM('D', input)});
+
+    int oxygen_distance = -1;
+    const size_t thread_count = max(1u, thread::hardware_concurrency());
+
+    for (int distance = 1; !frontier.empty(); distance++) {
+        // every unknown neighbour gets probed once, from the first frontier cell that sees it
+        vector<Probe> probes;
+        for (size_t i = 0; i < frontier.size(); i++) {
+            for (size_t d = 0; d < moves.size(); d++) {
+                const int x = frontier[i].x + dx[d];
+                const int y = frontier[i].y + dy[d];
+
+                if (maze.get(x, y) == UNKNOWN) {
+                    maze.set(x, y, PROBING);
+                    probes.push_back({i, moves[d], x, y, HIT_WALL, frontier[i].vm});
+                }
+            }
+        }
+
+        // run the probes, each on its own copy of the droid
+        atomic<size_t> next_probe = 0;
+        vector<thread> workers;
+        for (size_t t = 0; t < min(thread_count, probes.size()); t++) {
+            workers.emplace_back([&] {
+                for (size_t p = next_probe++; p < probes.size(); p = next_probe++) {
+                    Probe& probe = probes[p];
+                    probe.vm.inputs.push_back(probe.move);
+                    probe.status = run_program_15(probe.vm) ? probe.vm.output : HIT_WALL;
+                }
+            });
+        }
+        for (thread& w : workers) {
+            w.join();
+        }
+
+        // merge the results into the maze, the open cells form the next frontier
+        vector<DroidState> next_frontier;
+        for (Probe& probe : probes) {
+            if (probe.status == HIT_WALL) {
+                maze.set(probe.x, probe.y, WALL);
+                continue;
+            }
+
+            maze.set(probe.x, probe.y, probe.status == FOUND_OXYGEN ? OXYGEN : OPEN);
+            if (probe.status == FOUND_OXYGEN && oxygen_distance < 0) {
+                oxygen_distance = distance;
+            }
+            next_frontier.push_back({probe.x, probe.y, std::move(probe.vm)});
+        }
+
+        frontier = std::move(next_frontier);
+    }
+
+    return {maze, oxygen_distance};
+}
+
+// minutes until the oxygen from all sources has filled every open cell, a multi-source BFS
+int fill_time_15(const Maze& maze, const vector<pair<int, int>>& sources) {
+    constexpr array<int, 4> dx = {0, 0, -1, 1};
+    constexpr array<int, 4> dy = {-1, 1, 0, 0};
+
+    vector<int> minutes(maze.cells.size(), -1);
+    deque<pair<int, int>> queue;
+    int result = 0;
+
+    for (const auto& [x, y] : sources) {
+        minutes[(y - maze.min_y) * maze.width + x - maze.min_x] = 0;
+        queue.emplace_back(x, y);
+    }
+
+    while (!queue.empty()) {
+        const auto [x, y] = queue.front();
+        queue.pop_front();
+        const int current = minutes[(y - maze.min_y) * maze.width + x - maze.min_x];
+        result = max(result, current);
+
+        for (size_t d = 0; d < dx.size(); d++) {
+            const int nx = x + dx[d];
+            const int ny = y + dy[d];
+            const Cell c = maze.get(nx, ny);
+            if (c != OPEN && c != OXYGEN) {
+                continue;
+            }
+
+            int& m = minutes[(ny - maze.min_y) * maze.width + nx - maze.min_x];
+            if (m < 0) {
+                m = current + 1;
+                queue.emplace_back(nx, ny);
+            }
+        }
+    }
+
+    return result;
+}
+
+// whether the next instruction is an input while no input is queued
+bool needs_input_15(const VM &vm) {
+    return !vm.halted && vm.tape[vm.pc] % 100 == INPUT && vm.inputs.empty();
+}
+
+// runs until an output, input starvation or halt, returns whether it stopped on an output
+bool run_program_15(VM &vm) {
+    // if this does not run anymore
+    if (vm.halted) {
+        return false;
+    }
+
+    vm.paused = false;
+
+    // whilst we can do operations
+    while (vm.pc < vm.tape.size()) {
+        // pause until the host provides input
+        if (needs_input_15(vm)) {
+            vm.paused = true;
+            return false;
+        }
+
+        // fetch and run the instruction
+        IntCode instruction = read_instruction_15(vm);
+
+
+        run_instruction_15(vm, instruction);
+
+        // we stop once there is a halting or pausing occurring
+        if (vm.halted || vm.paused) {
+            break;
+        }
+
+    }
+
+    return vm.paused && !vm.halted;
+}
+
+// converts 5-digit number to array
+std::array<int, 5> to_array_15(int n) {
+    std::array result = {0,0,0,0,0};
+
+    for (int i = 4; i >= 0; i--) {
+        const int right = n % 10;
+        result[i] = right;
+        n /= 10;
+    }
+
+    return result;
+}
+
+IntCode read_instruction_15(const VM &vm) {
+    IntCode instruction;
+    instruction.modes_n_opcode = vm.tape[vm.pc];
+    const std::array<int, 5> modes_n_opcode = to_array_15(vm.tape[vm.pc]);
+
+    // read the parameter modes
+    instruction.mode_a = modes_n_opcode[2];
+    instruction.mode_b = modes_n_opcode[1];
+    instruction.mode_c = modes_n_opcode[0];
+
+    instruction.op_code = modes_n_opcode[3] * 10 + modes_n_opcode[4];
+
+    switch (instruction.op_code) {
+        // these all do the same in terms of arguments
+        case ADD:
+        case MULT:
+        case LESS_THAN:
+        case EQUALS:
+            instruction.offset = 4;
+            // first and second arguments based on instruction mode
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            if (instruction.mode_b == IMMEDIATE) {
+                instruction.b = vm.tape[vm.pc + 2];
+            } else if (instruction.mode_b == RELATIVE) {
+                instruction.b = vm.tape[vm.tape[vm.pc + 2] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_b == POSITION);
+                instruction.b = vm.tape[vm.tape[vm.pc + 2]];
+            }
+
+            if (instruction.mode_c == RELATIVE) {
+                instruction.c = vm.tape[vm.pc + 3] + vm.relative_offset;
+            } else {
+                assert(instruction.mode_c == POSITION); // cannot be immediate mode
+                instruction.c = vm.tape[vm.pc + 3];
+            }
+
+            break;
+            // Input output
+        case INPUT:
+            instruction.offset = 2;
+
+            if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.pc + 1] + vm.relative_offset;
+            } else {
+                assert(instruction.mode_a == POSITION); // cannot be immediate mode
+                instruction.a = vm.tape[vm.pc + 1];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case OUTPUT:
+            instruction.offset = 2;
+
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case RELATIVE_ADJUST:
+            instruction.offset = 2;
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case JUMP_FALSE:
+        case JUMP_TRUE:
+            instruction.offset = 3;
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            if (instruction.mode_b == IMMEDIATE) {
+                instruction.b = vm.tape[vm.pc + 2];
+            } else if (instruction.mode_b == RELATIVE) {
+                instruction.b = vm.tape[vm.tape[vm.pc + 2] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_b == POSITION);
+                instruction.b = vm.tape[vm.tape[vm.pc + 2]];
+            }
+
+            instruction.c = -1; // not used
+            break;
+        case END:
+            instruction.offset = 1;
+            instruction.a = -1; // not used
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        default:
+            assert(false);
+    }
+
+    return instruction;
+}
+
+void run_instruction_15(VM &vm, IntCode const &instruction) {
+    // if not a valid opcode
+    if (instruction.op_code != ADD && instruction.op_code != MULT &&
+        instruction.op_code != INPUT && instruction.op_code != OUTPUT &&
+        instruction.op_code != JUMP_FALSE && instruction.op_code != JUMP_TRUE &&
+        instruction.op_code != LESS_THAN && instruction.op_code != EQUALS && instruction.op_code != END &&
+        instruction.op_code != RELATIVE_ADJUST) {
+        std::cout << "Invalid op_code = " << instruction.op_code << std::endl;
+        std::cout << vm.tape[vm.pc] << "," << vm.tape[vm.pc + 1] << "," << vm.tape[vm.pc + 2] << "," << vm.tape[vm.pc + 3] << std::endl;
+
+        // program counter to the end and halt
+        vm.pc = vm.tape.size();
+        vm.halted = true;
+        return;
+    }
+
+    long result;
+    const long a = instruction.a;
+    const long b = instruction.b;
+    const long c = instruction.c;
+
+    // do the operation
+    switch (instruction.op_code) {
+        case ADD:
+            // add
+            result = a + b;
+            vm.tape[c] = result;
+            break;
+        case MULT:
+            // multiply
+            result = a * b;
+            vm.tape[c] = result;
+            break;
+        case INPUT:
+            // take input, if there is any
+            assert(!vm.inputs.empty());
+            vm.tape[a] = vm.inputs.front();
+            vm.inputs.pop_front();
+            break;
+        case OUTPUT:
+            // output pauses so that it can be retrieved
+            vm.output = a;
+            vm.paused = true;
+            break;
+        case JUMP_FALSE:
+            if (a == 0) {
+                vm.pc = b;
+                return;
+            }
+            break;
+        case JUMP_TRUE:
+            if (a != 0) {
+                vm.pc = b;
+                return;
+            }
+            break;
+        case LESS_THAN:
+            vm.tape[c] = a < b ? 1 : 0;
+            break;
+        case EQUALS:
+            vm.tape[c] = a == b ? 1 : 0;
+            break;
+        case RELATIVE_ADJUST:
+            vm.relative_offset += a;
+            break;
+        case END:
+            vm.halted = true;
+            vm.pc = vm.tape.size();
+            return;
+        default:
+            // should not be anything else
+            assert(false);
+    }
+
+    vm.pc += instruction.offset;
+
 
-    cout << "Nothing done here yet " << endl;
 }
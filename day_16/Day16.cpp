@@ -1,16 +1,234 @@
 #include "Day16.h"
 
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
-#include <map>
 #include <sstream>
-#include <math.h>
 #include <ostream>
-#include <queue>
-#include <set>
+#include <string>
+#include <thread>
 
 using namespace std;
 
+// other defined functions
+int32_t digit_sum_16(const vector<int32_t>& prefix, size_t n, size_t i);
+void fft_phase_16(const vector<int8_t>& signal, vector<int8_t>& result, vector<int32_t>& prefix, vector<int32_t>& sums);
+vector<int8_t> fft_16(vector<int8_t> signal, int phases);
+vector<int8_t> fft_parallel_16(vector<int8_t> signal, int phases, size_t thread_count);
+vector<int8_t> fft_tail_16(const vector<int8_t>& signal, size_t repeat, size_t offset, int phases);
+string digits_16(const vector<int8_t>& signal, size_t offset, size_t count);
+
 void Day16::execute(const vector<string>& lines) {
 
-    cout << "Nothing done here yet " << endl;
-}
\ No newline at end of file
+    // gathering input, one digit per element
+    vector<int8_t> signal;
+    for (const char c : lines.front()) {
+        if (c >= '0' && c <= '9') {
+            signal.push_back(static_cast<int8_t>(c - '0'));
+        }
+    }
+    // end gathering input
+
+    if (signal.size() < 8) {
+        cerr << "The signal should have at least 8 digits" << endl;
+        return;
+    }
+
+    cout << "Part 1: " << digits_16(fft_16(signal, 100), 0, 8) << endl;
+
+    // the message offset is given by the first seven digits
+    size_t offset = 0;
+    for (size_t i = 0; i < 7; i++) {
+        offset = offset * 10 + signal[i];
+    }
+
+    constexpr size_t repeat = 10000;
+    if (offset + 8 > signal.size() * repeat) {
+        cerr << "The message offset lies outside of the signal" << endl;
+        return;
+    }
+
+    cout << "Part 2: " << digits_16(fft_tail_16(signal, repeat, offset, 100), 0, 8) << endl;
+}
+
+// count digits starting at offset as a string
+string digits_16(const vector<int8_t>& signal, const size_t offset, const size_t count) {
+    string result;
+    for (size_t i = offset; i < offset + count && i < signal.size(); i++) {
+        result += static_cast<char>('0' + signal[i]);
+    }
+    return result;
+}
+
+// Sum for output digit i before taking the ones digit, from the prefix sums of a signal of length n
+int32_t digit_sum_16(const vector<int32_t>& prefix, const size_t n, const size_t i) {
+    const size_t length = i + 1;
+    int32_t sum = 0;
+
+    // the +1 blocks start at i, the -1 blocks 2 * length later, both repeating every 4 * length
+    for (size_t start = i; start < n; start += 4 * length) {
+        sum += prefix[min(n, start + length)] - prefix[start];
+
+        if (start + 2 * length < n) {
+            sum -= prefix[min(n, start + 3 * length)] - prefix[start + 2 * length];
+        }
+    }
+
+    return sum;
+}
+
+// One phase for an arbitrary signal. Output digit i uses the pattern 0, 1, 0, -1 with every element repeated
+// i + 1 times, so it is a sum of n / (i + 1) block sums, each O(1) from the prefix sums: O(n log n) in total.
+void fft_phase_16(const vector<int8_t>& signal, vector<int8_t>& result, vector<int32_t>& prefix, vector<int32_t>& sums) {
+    const size_t n = signal.size();
+
+    prefix[0] = 0;
+    for (size_t i = 0; i < n; i++) {
+        prefix[i + 1] = prefix[i] + signal[i];
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        sums[i] = digit_sum_16(prefix, n, i);
+    }
+
+    // only keep the ones digits, a straight int32 loop that the compiler vectorizes
+    for (size_t i = 0; i < n; i++) {
+        result[i] = static_cast<int8_t>(abs(sums[i]) % 10);
+    }
+}
+
+// run the amount of phases over the signal, long signals are spread over all cores
+vector<int8_t> fft_16(vector<int8_t> signal, const int phases) {
+    const size_t thread_count = thread::hardware_concurrency();
+    if (signal.size() >= 1 << 15 && thread_count > 1) {
+        return fft_parallel_16(std::move(signal), phases, thread_count);
+    }
+
+    vector<int8_t> next(signal.size());
+    vector<int32_t> prefix(signal.size() + 1);
+    vector<int32_t> sums(signal.size());
+
+    for (int phase = 0; phase < phases; phase++) {
+        fft_phase_16(signal, next, prefix, sums);
+        swap(signal, next);
+    }
+
+    return signal;
+}
+
+// The same phases on a pool of threads that stays alive for the whole run. Each phase builds the prefix sums
+// with a two pass scan over per thread ranges, then hands out the output digits in small blocks (the first
+// digits cost the most) and finally reduces its own range. Barriers separate the steps, the digit arrays are
+// double buffered and swapped once all threads are done with a phase.
+vector<int8_t> fft_parallel_16(vector<int8_t> signal, const int phases, const size_t thread_count) {
+    const size_t n = signal.size();
+    constexpr size_t block = 256;
+
+    vector<int8_t> next(n);
+    vector<int32_t> prefix(n + 1);
+    vector<int32_t> sums(n);
+    vector<int32_t> range_sums(thread_count);
+    atomic<size_t> next_block = 0;
+
+    barrier sync(static_cast<ptrdiff_t>(thread_count));
+    barrier end_of_phase(static_cast<ptrdiff_t>(thread_count), [&]() noexcept {
+        swap(signal, next);
+        next_block = 0;
+    });
+
+    const auto worker = [&](const size_t t) {
+        const size_t begin = n * t / thread_count;
+        const size_t end = n * (t + 1) / thread_count;
+
+        for (int phase = 0; phase < phases; phase++) {
+            // prefix sums, first the sum of every range
+            int32_t sum = 0;
+            for (size_t i = begin; i < end; i++) {
+                sum += signal[i];
+            }
+            range_sums[t] = sum;
+            sync.arrive_and_wait();
+
+            // then every range continues from the sum of all ranges before it
+            sum = 0;
+            for (size_t r = 0; r < t; r++) {
+                sum += range_sums[r];
+            }
+            if (t == 0) {
+                prefix[0] = 0;
+            }
+            for (size_t i = begin; i < end; i++) {
+                sum += signal[i];
+                prefix[i + 1] = sum;
+            }
+            sync.arrive_and_wait();
+
+            // output digits, in blocks from a shared counter
+            for (size_t b = next_block++; b * block < n; b = next_block++) {
+                for (size_t i = b * block; i < min(n, (b + 1) * block); i++) {
+                    sums[i] = digit_sum_16(prefix, n, i);
+                }
+            }
+            sync.arrive_and_wait();
+
+            // only keep the ones digits of the own range
+            for (size_t i = begin; i < end; i++) {
+                next[i] = static_cast<int8_t>(abs(sums[i]) % 10);
+            }
+            end_of_phase.arrive_and_wait();
+        }
+    };
+
+    vector<thread> workers;
+    for (size_t t = 0; t < thread_count; t++) {
+        workers.emplace_back(worker, t);
+    }
+    for (thread& w : workers) {
+        w.join();
+    }
+
+    return signal;
+}
+
+// The digits from offset onwards of the signal repeated repeat times, after the amount of phases.
+// In the second half of the signal the pattern is 0 before i and 1 from i on, so a phase is a suffix sum.
+// Only the part from the offset onwards is materialized, otherwise it falls back to the general kernel.
+vector<int8_t> fft_tail_16(const vector<int8_t>& signal, const size_t repeat, const size_t offset, const int phases) {
+    const size_t total = signal.size() * repeat;
+
+    if (offset < total / 2) {
+        vector<int8_t> full;
+        full.reserve(total);
+        for (size_t r = 0; r < repeat; r++) {
+            full.insert(full.end(), signal.begin(), signal.end());
+        }
+
+        const vector<int8_t> result = fft_16(std::move(full), phases);
+        return {result.begin() + static_cast<long>(offset), result.end()};
+    }
+
+    const size_t n = total - offset;
+    vector<int8_t> tail(n);
+    for (size_t i = 0; i < n; i++) {
+        tail[i] = signal[(offset + i) % signal.size()];
+    }
+
+    // suffix sums stay below 9 * n, so they fit in int32 without reducing every step
+    vector<int32_t> sums(n);
+    for (int phase = 0; phase < phases; phase++) {
+        int32_t sum = 0;
+        for (size_t i = n; i-- > 0;) {
+            sum += tail[i];
+            sums[i] = sum;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            tail[i] = static_cast<int8_t>(sums[i] % 10);
+        }
+    }
+
+    return tail;
+}
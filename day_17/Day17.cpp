@@ -1,13 +1,625 @@
 #include "Day17.h"
 
-#include <cmath>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <deque>
 #include <iostream>
 #include <sstream>
-#include <thread>
+#include <string>
+#include <unordered_set>
+#include <utility>
 
 using namespace std;
 
+// OpCode int
+typedef int OpCode;
+constexpr OpCode ADD = 1;
+constexpr OpCode MULT = 2;
+constexpr OpCode INPUT = 3;
+constexpr OpCode OUTPUT = 4;
+constexpr OpCode JUMP_TRUE = 5;
+constexpr OpCode JUMP_FALSE = 6;
+constexpr OpCode LESS_THAN = 7;
+constexpr OpCode EQUALS = 8;
+constexpr OpCode RELATIVE_ADJUST = 9;
+constexpr OpCode END = 99;
+
+// ParameterMode int
+typedef int ParameterMode;
+constexpr ParameterMode POSITION = 0;
+constexpr ParameterMode IMMEDIATE = 1;
+constexpr ParameterMode RELATIVE = 2;
+
+// IntCode struct
+typedef struct IntCode {
+    long modes_n_opcode;     // The full int of the instruction
+    OpCode op_code;         // after deconstruction, the op_code
+    ParameterMode mode_a;   // after deconstruction, the mode of a
+    ParameterMode mode_b;   // after deconstruction, the mode of b
+    ParameterMode mode_c;   // after deconstruction, the mode of c
+    long a;                  // argument 1
+    long b;                  // argument 2
+    long c;                  // argument 3
+    int offset;             // offset depending on the opcode
+} IntCode;
+
+// VM struct
+typedef struct VM {
+    char tag;                   // identifier
+    size_t pc;                  // program counter
+    std::vector<long> tape;      // the program to work on
+    std::deque<long> inputs;     // the inputs given to the machine
+    long output;                 // an output of the machine
+    bool halted;                // halted or not
+    bool paused;                // paused or not
+    long relative_offset;
+
+    // constructor
+    VM(const char t, std::vector<long> program)
+        : tag(t), pc(0), tape(std::move(program)), output(0), halted(false), paused(false), relative_offset(0) {
+        tape.resize(tape.size() + 10000, 0); // add additional zeros for day 9
+    }
+} VM;
+
+
+// Scaffold camera image as a bit grid, bit x % 64 of word x / 64 in a row is set for scaffold at (x, y)
+typedef struct Scaffold {
+    int width = 0;
+    int height = 0;
+    int words = 0;            // words per row, one extra word of padding on both sides
+    vector<uint64_t> bits;
+    int robot_x = -1;         // position and direction (one of ^v<>) of the vacuum robot
+    int robot_y = -1;
+    char robot_d = '^';
+
+    explicit Scaffold(const vector<string>& image) {
+        height = static_cast<int>(image.size());
+        for (const string& row : image) {
+            width = max(width, static_cast<int>(row.size()));
+        }
+        words = (width + 63) / 64 + 2;
+        bits.assign(static_cast<size_t>(words) * (height + 2), 0);
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < static_cast<int>(image[y].size()); x++) {
+                const char c = image[y][x];
+                if (c == '.' || c == 'X') {
+                    continue;
+                }
+                if (c == '^' || c == 'v' || c == '<' || c == '>') {
+                    robot_x = x;
+                    robot_y = y;
+                    robot_d = c;
+                }
+                row(y)[x / 64 + 1] |= uint64_t{1} << (x % 64);
+            }
+        }
+    }
+
+    // words of row y, rows -1 and height are empty padding
+    uint64_t* row(const int y) {
+        return &bits[static_cast<size_t>(y + 1) * words];
+    }
+
+    [[nodiscard]] const uint64_t* row(const int y) const {
+        return &bits[static_cast<size_t>(y + 1) * words];
+    }
+
+    [[nodiscard]] bool get(const int x, const int y) const {
+        if (x < 0 || y < 0 || x >= width || y >= height) {
+            return false;
+        }
+        return row(y)[x / 64 + 1] >> (x % 64) & 1;
+    }
+
+    // sum of x * y over all intersections, checks 64 cells at once against their four neighbours
+    [[nodiscard]] long alignment_sum() const {
+        long result = 0;
+
+        for (int y = 0; y < height; y++) {
+            const uint64_t* up = row(y - 1);
+            const uint64_t* here = row(y);
+            const uint64_t* down = row(y + 1);
+
+            for (int w = 1; w < words - 1; w++) {
+                const uint64_t left = here[w] << 1 | here[w - 1] >> 63;
+                const uint64_t right = here[w] >> 1 | here[w + 1] << 63;
+
+                for (uint64_t m = here[w] & left & right & up[w] & down[w]; m != 0; m &= m - 1) {
+                    result += static_cast<long>((w - 1) * 64 + countr_zero(m)) * y;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // the route that walks the whole scaffold: turn, then as far forward as possible, e.g. R,8,L,10,...
+    [[nodiscard]] vector<string> path() const {
+        constexpr array<int, 4> dx = {0, 1, 0, -1}; // up, right, down, left
+        constexpr array<int, 4> dy = {-1, 0, 1, 0};
+
+        vector<string> result;
+        int x = robot_x, y = robot_y;
+        int d = robot_d == '^' ? 0 : robot_d == '>' ? 1 : robot_d == 'v' ? 2 : 3;
+
+        while (true) {
+            string turn;
+            if (get(x + dx[(d + 1) % 4], y + dy[(d + 1) % 4])) {
+                turn = "R";
+                d = (d + 1) % 4;
+            } else if (get(x + dx[(d + 3) % 4], y + dy[(d + 3) % 4])) {
+                turn = "L";
+                d = (d + 3) % 4;
+            } else {
+                break;
+            }
+
+            int steps = 0;
+            while (get(x + dx[d], y + dy[d])) {
+                x += dx[d];
+                y += dy[d];
+                steps++;
+            }
+
+            result.push_back(turn);
+            result.push_back(to_string(steps));
+        }
+
+        return result;
+    }
+} Scaffold;
+
+// Split a path into a main routine calling at most max_functions movement functions, every routine
+// at most max_chars characters long. Depth first over the path position, trying the existing functions
+// first and otherwise defining the next one; failed (position, functions) states are memoized.
+typedef struct RoutineCompressor {
+    const vector<string>& path;
+    size_t max_chars;
+    size_t max_functions;
+    vector<pair<size_t, size_t>> functions;  // (start, length) of every function in the path
+    vector<size_t> calls;                    // main routine
+    unordered_set<string> failed;
+
+    RoutineCompressor(const vector<string>& path, const size_t max_chars, const size_t max_functions)
+        : path(path), max_chars(max_chars), max_functions(max_functions) {}
+
+    // characters of the comma separated path elements [start, start + length)
+    [[nodiscard]] size_t chars(const size_t start, const size_t length) const {
+        size_t result = length - 1;
+        for (size_t i = start; i < start + length; i++) {
+            result += path[i].size();
+        }
+        return result;
+    }
+
+    [[nodiscard]] bool matches(const pair<size_t, size_t>& function, const size_t pos) const {
+        const auto [start, length] = function;
+        return pos + length <= path.size() &&
+               equal(path.begin() + static_cast<long>(start), path.begin() + static_cast<long>(start + length),
+                     path.begin() + static_cast<long>(pos));
+    }
+
+    [[nodiscard]] string key(const size_t pos) const {
+        string result = to_string(pos) + ":" + to_string(calls.size());
+        for (const auto& [start, length] : functions) {
+            result += "|";
+            for (size_t i = start; i < start + length; i++) {
+                result += path[i] + ",";
+            }
+        }
+        return result;
+    }
+
+    bool solve(const size_t pos) {
+        if (pos == path.size()) {
+            return true;
+        }
+
+        // the main routine would become too long with another call
+        if (2 * calls.size() + 1 > max_chars) {
+            return false;
+        }
+
+        const string state = key(pos);
+        if (failed.contains(state)) {
+            return false;
+        }
+
+        for (size_t f = 0; f < functions.size(); f++) {
+            if (matches(functions[f], pos)) {
+                calls.push_back(f);
+                if (solve(pos + functions[f].second)) {
+                    return true;
+                }
+                calls.pop_back();
+            }
+        }
+
+        // define a new function starting here, longest first
+        if (functions.size() < max_functions) {
+            size_t length = 1;
+            while (pos + length < path.size() && chars(pos, length + 1) <= max_chars) {
+                length++;
+            }
+
+            for (; length > 0; length--) {
+                if (chars(pos, length) > max_chars) {
+                    continue;
+                }
+
+                functions.emplace_back(pos, length);
+                calls.push_back(functions.size() - 1);
+                if (solve(pos + length)) {
+                    return true;
+                }
+                calls.pop_back();
+                functions.pop_back();
+            }
+        }
+
+        failed.insert(state);
+        return false;
+    }
+
+    // the routines as ASCII lines: main routine first, then one line per function
+    [[nodiscard]] vector<string> routines() const {
+        vector<string> result;
+
+        string main_routine;
+        for (const size_t c : calls) {
+            main_routine += (main_routine.empty() ? "" : ",") + string(1, static_cast<char>('A' + c));
+        }
+        result.push_back(main_routine);
+
+        for (size_t f = 0; f < max_functions; f++) {
+            string function;
+            if (f < functions.size()) {
+                for (size_t i = functions[f].first; i < functions[f].first + functions[f].second; i++) {
+                    function += (function.empty() ? "" : ",") + path[i];
+                }
+            }
+            // unused functions still have to be provided
+            result.push_back(function.empty() ? "L" : function);
+        }
+
+        return result;
+    }
+} RoutineCompressor;
+
+// other defined functions
+vector<string> camera_17(const std::vector<long>& input);
+bool needs_input_17(const VM &vm);
+bool run_program_17(VM &vm);
+IntCode read_instruction_17(const VM &vm);
+void run_instruction_17(VM &vm, IntCode const &instruction);
+
+// Main function of this file
 void Day17::execute(const vector<string>& lines) {
+    // gathering input and putting it into an array
+    vector<long> input;
+
+    stringstream ss(lines.front());
+    string interim_result;
+
+    while (getline(ss, interim_result, ',')) {
+        input.push_back(stol(interim_result));
+    }
+    // end gathering input
+
+    const Scaffold scaffold(camera_17(input));
+    cout << "Part 1: " << scaffold.alignment_sum() << endl;
+
+    if (scaffold.robot_x < 0) {
+        cerr << "No vacuum robot on the camera image" << endl;
+        return;
+    }
+
+    const vector<string> path = scaffold.path();
+    RoutineCompressor compressor(path, 20, 3);
+    if (!compressor.solve(0)) {
+        cerr << "The path does not fit in the movement routines" << endl;
+        return;
+    }
+
+    // wake the robot up and feed it the routines, without the video feed
+    VM vm('V', input);
+    vm.tape[0] = 2;
+    for (const string& routine : compressor.routines()) {
+        for (const char c : routine) {
+            vm.inputs.push_back(c);
+        }
+        vm.inputs.push_back('\n');
+    }
+    vm.inputs.push_back('n');
+    vm.inputs.push_back('\n');
+
+    // the dust is the only non ASCII output
+    long dust = -1;
+    while (run_program_17(vm)) {
+        if (vm.output > 127) {
+            dust = vm.output;
+        }
+    }
+
+    cout << "Part 2: " << dust << endl;
+}
+
+// the ASCII camera image, one string per row
+vector<string> camera_17(const std::vector<long>& input) {
+    VM vm('C', input);
+    vector<string> image = {""};
+
+    while (run_program_17(vm)) {
+        if (vm.output == '\n') {
+            image.emplace_back();
+        } else {
+            image.back() += static_cast<char>(vm.output);
+        }
+    }
+
+    // drop the trailing empty lines
+    while (!image.empty() && image.back().empty()) {
+        image.pop_back();
+    }
+
+    return image;
+}
+
+// whether the next instruction is an input while no input is queued
+bool needs_input_17(const VM &vm) {
+    return !vm.halted && vm.tape[vm.pc] % 100 == INPUT && vm.inputs.empty();
+}
+
+// runs until an output, input starvation or halt, returns whether it stopped on an output
+bool run_program_17(VM &vm) {
+    // if this does not run anymore
+    if (vm.halted) {
+        return false;
+    }
+
+    vm.paused = false;
+
+    // whilst we can do operations
+    while (vm.pc < vm.tape.size()) {
+        // pause until the host provides input
+        if (needs_input_17(vm)) {
+            vm.paused = true;
+            return false;
+        }
+
+        // fetch and run the instruction
+        IntCode instruction = read_instruction_17(vm);
+
+
+        run_instruction_17(vm, instruction);
+
+        // we stop once there is a halting or pausing occurring
+        if (vm.halted || vm.paused) {
+            break;
+        }
+
+    }
+
+    return vm.paused && !vm.halted;
+}
+
+// converts 5-digit number to array
+std::array<int, 5> to_array_17(int n) {
+    std::array result = {0,0,0,0,0};
+
+    for (int i = 4; i >= 0; i--) {
+        const int right = n % 10;
+        result[i] = right;
+        n /= 10;
+    }
+
+    return result;
+}
+
+IntCode read_instruction_17(const VM &vm) {
+    IntCode instruction;
+    instruction.modes_n_opcode = vm.tape[vm.pc];
+    const std::array<int, 5> modes_n_opcode = to_array_17(vm.tape[vm.pc]);
+
+    // read the parameter modes
+    instruction.mode_a = modes_n_opcode[2];
+    instruction.mode_b = modes_n_opcode[1];
+    instruction.mode_c = modes_n_opcode[0];
+
+    instruction.op_code = modes_n_opcode[3] * 10 + modes_n_opcode[4];
+
+    switch (instruction.op_code) {
+        // these all do the same in terms of arguments
+        case ADD:
+        case MULT:
+        case LESS_THAN:
+        case EQUALS:
+            instruction.offset = 4;
+            // first and second arguments based on instruction mode
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            if (instruction.mode_b == IMMEDIATE) {
+                instruction.b = vm.tape[vm.pc + 2];
+            } else if (instruction.mode_b == RELATIVE) {
+                instruction.b = vm.tape[vm.tape[vm.pc + 2] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_b == POSITION);
+                instruction.b = vm.tape[vm.tape[vm.pc + 2]];
+            }
+
+            if (instruction.mode_c == RELATIVE) {
+                instruction.c = vm.tape[vm.pc + 3] + vm.relative_offset;
+            } else {
+                assert(instruction.mode_c == POSITION); // cannot be immediate mode
+                instruction.c = vm.tape[vm.pc + 3];
+            }
+
+            break;
+            // Input output
+        case INPUT:
+            instruction.offset = 2;
+
+            if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.pc + 1] + vm.relative_offset;
+            } else {
+                assert(instruction.mode_a == POSITION); // cannot be immediate mode
+                instruction.a = vm.tape[vm.pc + 1];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case OUTPUT:
+            instruction.offset = 2;
+
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case RELATIVE_ADJUST:
+            instruction.offset = 2;
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case JUMP_FALSE:
+        case JUMP_TRUE:
+            instruction.offset = 3;
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            if (instruction.mode_b == IMMEDIATE) {
+                instruction.b = vm.tape[vm.pc + 2];
+            } else if (instruction.mode_b == RELATIVE) {
+                instruction.b = vm.tape[vm.tape[vm.pc + 2] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_b == POSITION);
+                instruction.b = vm.tape[vm.tape[vm.pc + 2]];
+            }
+
+            instruction.c = -1; // not used
+            break;
+        case END:
+            instruction.offset = 1;
+            instruction.a = -1; // not used
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        default:
+            assert(false);
+    }
+
+    return instruction;
+}
+
+void run_instruction_17(VM &vm, IntCode const &instruction) {
+    // if not a valid opcode
+    if (instruction.op_code != ADD && instruction.op_code != MULT &&
+        instruction.op_code != INPUT && instruction.op_code != OUTPUT &&
+        instruction.op_code != JUMP_FALSE && instruction.op_code != JUMP_TRUE &&
+        instruction.op_code != LESS_THAN && instruction.op_code != EQUALS && instruction.op_code != END &&
+        instruction.op_code != RELATIVE_ADJUST) {
+        std::cout << "Invalid op_code = " << instruction.op_code << std::endl;
+        std::cout << vm.tape[vm.pc] << "," << vm.tape[vm.pc + 1] << "," << vm.tape[vm.pc + 2] << "," << vm.tape[vm.pc + 3] << std::endl;
+
+        // program counter to the end and halt
+        vm.pc = vm.tape.size();
+        vm.halted = true;
+        return;
+    }
+
+    long result;
+    const long a = instruction.a;
+    const long b = instruction.b;
+    const long c = instruction.c;
+
+    // do the operation
+    switch (instruction.op_code) {
+        case ADD:
+            // add
+            result = a + b;
+            vm.tape[c] = result;
+            break;
+        case MULT:
+            // multiply
+            result = a * b;
+            vm.tape[c] = result;
+            break;
+        case INPUT:
+            // take input, if there is any
+            assert(!vm.inputs.empty());
+            vm.tape[a] = vm.inputs.front();
+            vm.inputs.pop_front();
+            break;
+        case OUTPUT:
+            // output pauses so that it can be retrieved
+            vm.output = a;
+            vm.paused = true;
+            break;
+        case JUMP_FALSE:
+            if (a == 0) {
+                vm.pc = b;
+                return;
+            }
+            break;
+        case JUMP_TRUE:
+            if (a != 0) {
+                vm.pc = b;
+                return;
+            }
+            break;
+        case LESS_THAN:
+            vm.tape[c] = a < b ? 1 : 0;
+            break;
+        case EQUALS:
+            vm.tape[c] = a == b ? 1 : 0;
+            break;
+        case RELATIVE_ADJUST:
+            vm.relative_offset += a;
+            break;
+        case END:
+            vm.halted = true;
+            vm.pc = vm.tape.size();
+            return;
+        default:
+            // should not be anything else
+            assert(false);
+    }
+
+    vm.pc += instruction.offset;
+
 
-    cout << "Nothing done here yet " << endl;
 }
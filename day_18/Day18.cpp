@@ -1,16 +1,320 @@
 #include "Day18.h"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
 #include <deque>
+#include <functional>
 #include <iostream>
-#include <map>
-#include <sstream>
-#include <memory>
 #include <queue>
-#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
 
 using namespace std;
 
+// walk from a node to a key, with the doors and the other keys on the way
+typedef struct KeyRoute {
+    int distance = -1;
+    uint32_t doors = 0;  // bit k is set for door 'A' + k
+    uint32_t keys = 0;   // bit k is set for key 'a' + k, the target itself excluded
+} KeyRoute;
+
+// The vault reduced to routes between the robots (nodes 0 .. robots - 1) and the keys (node robots + k for 'a' + k)
+typedef struct Vault {
+    vector<string> grid;
+    int robots = 0;
+    int keys = 0;
+    uint32_t all_keys = 0;
+    vector<pair<int, int>> nodes;     // (x, y) of every node, unused keys stay at (-1, -1)
+    vector<vector<KeyRoute>> routes;  // from node n to key k at n * 26 + k, by increasing distance
+
+    explicit Vault(vector<string> map) : grid(std::move(map)) {
+        vector<pair<int, int>> starts;
+        array<pair<int, int>, 26> key_positions;
+        key_positions.fill({-1, -1});
+
+        for (int y = 0; y < static_cast<int>(grid.size()); y++) {
+            for (int x = 0; x < static_cast<int>(grid[y].size()); x++) {
+                const char c = grid[y][x];
+                if (c == '@') {
+                    starts.emplace_back(x, y);
+                } else if (c >= 'a' && c <= 'z') {
+                    key_positions[c - 'a'] = {x, y};
+                    keys = max(keys, c - 'a' + 1);
+                    all_keys |= 1u << (c - 'a');
+                }
+            }
+        }
+
+        robots = static_cast<int>(starts.size());
+        nodes = starts;
+        nodes.insert(nodes.end(), key_positions.begin(), key_positions.begin() + keys);
+
+        routes.resize(nodes.size() * 26);
+        for (size_t n = 0; n < nodes.size(); n++) {
+            if (nodes[n].first >= 0) {
+                bfs(static_cast<int>(n));
+            }
+        }
+    }
+
+    [[nodiscard]] const vector<KeyRoute>& route(const int from, const int key) const {
+        return routes[from * 26 + key];
+    }
+
+    [[nodiscard]] char at(const int x, const int y) const {
+        if (y < 0 || y >= static_cast<int>(grid.size()) || x < 0 || x >= static_cast<int>(grid[y].size())) {
+            return '#';
+        }
+        return grid[y][x];
+    }
+
+    // One BFS over (tile, doors and keys passed) from a node, filling in its routes to all keys. With loops in
+    // the vault a longer walk can need fewer doors, so every tile keeps the doors and keys of each walk that
+    // reached it. A later walk is dropped when an earlier one needed a subset of its doors and keys, the
+    // walks that remain per key are the Pareto front of distance against what has to be open.
+    void bfs(const int from) {
+        constexpr array<int, 4> dx = {0, 0, -1, 1};
+        constexpr array<int, 4> dy = {-1, 1, 0, 0};
+
+        // doors | keys of the walks that reached a tile, door 'A' + k and key 'a' + k share bit k
+        vector<vector<vector<uint32_t>>> seen(grid.size());
+        for (size_t y = 0; y < grid.size(); y++) {
+            seen[y].resize(grid[y].size());
+        }
+
+        const auto dominated = [&](const int x, const int y, const uint32_t needs) {
+            return any_of(seen[y][x].begin(), seen[y][x].end(), [needs](const uint32_t other) {
+                return (other & ~needs) == 0;
+            });
+        };
+
+        // (x, y, distance, doors, keys)
+        deque<tuple<int, int, int, uint32_t, uint32_t>> queue;
+        queue.emplace_back(nodes[from].first, nodes[from].second, 0, 0, 0);
+        seen[nodes[from].second][nodes[from].first].push_back(0);
+
+        while (!queue.empty()) {
+            auto [x, y, distance, doors, keys_on_way] = queue.front();
+            queue.pop_front();
+
+            const char c = at(x, y);
+            if (c >= 'a' && c <= 'z' && distance > 0) {
+                routes[from * 26 + (c - 'a')].push_back({distance, doors, keys_on_way});
+                keys_on_way |= 1u << (c - 'a');
+            }
+            if (c >= 'A' && c <= 'Z') {
+                doors |= 1u << (c - 'A');
+            }
+
+            for (size_t d = 0; d < dx.size(); d++) {
+                const int nx = x + dx[d];
+                const int ny = y + dy[d];
+                if (at(nx, ny) == '#' || dominated(nx, ny, doors | keys_on_way)) {
+                    continue;
+                }
+                seen[ny][nx].push_back(doors | keys_on_way);
+                queue.emplace_back(nx, ny, distance + 1, doors, keys_on_way);
+            }
+        }
+    }
+} Vault;
+
+// Open addressing table from packed state to best distance, sized once from a memory budget.
+// Packed state: 5 bits per robot position (node index) above the 26 bit key mask.
+typedef struct StateTable {
+    static constexpr uint64_t EMPTY = ~uint64_t{0};
+
+    vector<uint64_t> states;
+    vector<uint32_t> distances;
+    size_t mask;
+    size_t size = 0;
+
+    explicit StateTable(const size_t budget_bytes) {
+        size_t capacity = 1024;
+        while (capacity * 2 * (sizeof(uint64_t) + sizeof(uint32_t)) <= budget_bytes) {
+            capacity *= 2;
+        }
+        states.assign(capacity, EMPTY);
+        distances.assign(capacity, 0);
+        mask = capacity - 1;
+    }
+
+    // slot of the state, or of the empty slot where it would go
+    [[nodiscard]] size_t find(const uint64_t state) const {
+        size_t slot = (state * 0x9E3779B97F4A7C15ULL) >> 20 & mask;
+        while (states[slot] != EMPTY && states[slot] != state) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    // lower the distance of a state, false if it was not an improvement
+    bool improve(const uint64_t state, const uint32_t distance) {
+        const size_t slot = find(state);
+        if (states[slot] == EMPTY) {
+            states[slot] = state;
+            distances[slot] = distance;
+            size++;
+            return true;
+        }
+        if (distance < distances[slot]) {
+            distances[slot] = distance;
+            return true;
+        }
+        return false;
+    }
+
+    [[nodiscard]] uint32_t get(const uint64_t state) const {
+        return distances[find(state)];
+    }
+
+    // keep the load factor below 3/4
+    [[nodiscard]] bool full() const {
+        return 4 * size >= 3 * (mask + 1);
+    }
+} StateTable;
+
+// other defined functions
+long collect_keys_18(const Vault& vault, size_t budget_bytes);
+vector<string> split_quadrants_18(vector<string> map);
+
 void Day18::execute(const vector<string>& lines) {
 
-    cout << "Nothing done here yet " << endl;
-}
\ No newline at end of file
+    vector<string> map;
+    for (const string& line : lines) {
+        if (!line.empty()) {
+            map.push_back(line);
+        }
+    }
+
+    constexpr size_t budget = size_t{256} << 20;
+
+    // maps that are already split into quadrants only have the second part
+    const Vault vault(map);
+    if (vault.robots == 1) {
+        const long part_1 = collect_keys_18(vault, budget);
+        cout << "Part 1: " << part_1 << endl;
+    }
+
+    const Vault quadrants = vault.robots == 4 ? vault : Vault(split_quadrants_18(map));
+    if (quadrants.robots != 4) {
+        cerr << "The entrance cannot be split into four quadrants" << endl;
+        return;
+    }
+    const long part_2 = collect_keys_18(quadrants, budget);
+    cout << "Part 2: " << part_2 << endl;
+}
+
+// replace the single entrance and its open neighbours by walls and put a robot in every diagonal corner
+vector<string> split_quadrants_18(vector<string> map) {
+    for (int y = 1; y + 1 < static_cast<int>(map.size()); y++) {
+        for (int x = 1; x + 1 < static_cast<int>(map[y].size()); x++) {
+            if (map[y][x] != '@') {
+                continue;
+            }
+
+            // the entrance needs open floor all around it, otherwise the map is returned as is
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if ((dx != 0 || dy != 0) && (x + dx >= static_cast<int>(map[y + dy].size()) ||
+                                                 map[y + dy][x + dx] != '.')) {
+                        return map;
+                    }
+                }
+            }
+
+            map[y - 1].replace(x - 1, 3, "@#@");
+            map[y].replace(x - 1, 3, "###");
+            map[y + 1].replace(x - 1, 3, "@#@");
+            return map;
+        }
+    }
+
+    return map;
+}
+
+// Fewest steps to collect all keys, Dijkstra over (robot positions, collected keys). Successors only need
+// bitwise tests against the precomputed routes, the grid is never walked during the search.
+// Returns -1 if the keys cannot all be collected or the states do not fit in the memory budget.
+long collect_keys_18(const Vault& vault, const size_t budget_bytes) {
+    assert(vault.robots <= 4 && vault.robots + vault.keys <= 32);
+
+    const auto pack = [](const array<int, 4>& positions, const uint32_t keys) {
+        uint64_t state = keys;
+        for (size_t r = 0; r < positions.size(); r++) {
+            state |= static_cast<uint64_t>(positions[r]) << (26 + 5 * r);
+        }
+        return state;
+    };
+
+    const auto unpack = [](const uint64_t state, array<int, 4>& positions, uint32_t& keys) {
+        keys = static_cast<uint32_t>(state & ((1u << 26) - 1));
+        for (size_t r = 0; r < positions.size(); r++) {
+            positions[r] = static_cast<int>(state >> (26 + 5 * r) & 31);
+        }
+    };
+
+    StateTable best(budget_bytes);
+    priority_queue<pair<uint32_t, uint64_t>, vector<pair<uint32_t, uint64_t>>, greater<>> queue;
+
+    array<int, 4> start = {0, 0, 0, 0};
+    for (int r = 0; r < vault.robots; r++) {
+        start[r] = r;
+    }
+    best.improve(pack(start, 0), 0);
+    queue.emplace(0, pack(start, 0));
+
+    while (!queue.empty()) {
+        const auto [distance, state] = queue.top();
+        queue.pop();
+
+        if (distance > best.get(state)) {
+            continue;
+        }
+
+        array<int, 4> positions;
+        uint32_t keys;
+        unpack(state, positions, keys);
+
+        if (keys == vault.all_keys) {
+            return distance;
+        }
+
+        for (int r = 0; r < vault.robots; r++) {
+            // a key is a successor over its shortest route with the doors open and no other new key on the
+            // way, that one would be picked up first and is a successor of its own
+            for (int k = 0; k < vault.keys; k++) {
+                if (keys >> k & 1) {
+                    continue;
+                }
+                const vector<KeyRoute>& routes = vault.route(positions[r], k);
+                const auto open = find_if(routes.begin(), routes.end(), [keys](const KeyRoute& route) {
+                    return ((route.doors | route.keys) & ~keys) == 0;
+                });
+                if (open == routes.end()) {
+                    continue;
+                }
+                const KeyRoute& route = *open;
+
+                array<int, 4> next = positions;
+                next[r] = vault.robots + k;
+                const uint64_t next_state = pack(next, keys | 1u << k);
+
+                if (best.improve(next_state, distance + route.distance)) {
+                    queue.emplace(distance + route.distance, next_state);
+                }
+            }
+
+            if (best.full()) {
+                cerr << "Out of the memory budget for states" << endl;
+                return -1;
+            }
+        }
+    }
+
+    cerr << "Not all keys can be collected" << endl;
+    return -1;
+}
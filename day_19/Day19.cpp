@@ -1,13 +1,560 @@
 #include "Day19.h"
 
 #include <algorithm>
-#include <cmath>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <map>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 
 using namespace std;
 
+// OpCode int
+typedef int OpCode;
+constexpr OpCode ADD = 1;
+constexpr OpCode MULT = 2;
+constexpr OpCode INPUT = 3;
+constexpr OpCode OUTPUT = 4;
+constexpr OpCode JUMP_TRUE = 5;
+constexpr OpCode JUMP_FALSE = 6;
+constexpr OpCode LESS_THAN = 7;
+constexpr OpCode EQUALS = 8;
+constexpr OpCode RELATIVE_ADJUST = 9;
+constexpr OpCode END = 99;
+
+// ParameterMode int
+typedef int ParameterMode;
+constexpr ParameterMode POSITION = 0;
+constexpr ParameterMode IMMEDIATE = 1;
+constexpr ParameterMode RELATIVE = 2;
+
+// IntCode struct
+typedef struct IntCode {
+    long modes_n_opcode;     // The full int of the instruction
+    OpCode op_code;         // after deconstruction, the op_code
+    ParameterMode mode_a;   // after deconstruction, the mode of a
+    ParameterMode mode_b;   // after deconstruction, the mode of b
+    ParameterMode mode_c;   // after deconstruction, the mode of c
+    long a;                  // argument 1
+    long b;                  // argument 2
+    long c;                  // argument 3
+    int offset;             // offset depending on the opcode
+} IntCode;
+
+// VM struct
+typedef struct VM {
+    char tag;                   // identifier
+    size_t pc;                  // program counter
+    std::vector<long> tape;      // the program to work on
+    std::deque<long> inputs;     // the inputs given to the machine
+    long output;                 // an output of the machine
+    bool halted;                // halted or not
+    bool paused;                // paused or not
+    long relative_offset;
+
+    // constructor
+    VM(const char t, std::vector<long> program)
+        : tag(t), pc(0), tape(std::move(program)), output(0), halted(false), paused(false), relative_offset(0) {
+        tape.resize(tape.size() + 10000, 0); // add additional zeros for day 9
+    }
+} VM;
+
+
+// other defined functions
+bool needs_input_19(const VM &vm);
+bool run_program_19(VM &vm);
+IntCode read_instruction_19(const VM &vm);
+void run_instruction_19(VM &vm, IntCode const &instruction);
+
+// The tractor beam, every probe is a run of the drone program from a fresh VM.
+// Probes are cached so that no point is evaluated twice, rows are reduced to their left and right edge.
+typedef struct TractorBeam {
+    const vector<long>& program;
+    unordered_map<uint64_t, bool> cache;
+    map<long, pair<long, long>> rows;  // (left, right) edge per row, left > right for an empty row
+    size_t probes = 0;                 // amount of VM runs
+
+    explicit TractorBeam(const vector<long>& program) : program(program) {}
+
+    static uint64_t key(const long x, const long y) {
+        return static_cast<uint64_t>(x) << 32 | static_cast<uint32_t>(y);
+    }
+
+    // run the drone program once for a point
+    [[nodiscard]] bool run(const long x, const long y) const {
+        VM vm('B', program);
+        vm.inputs.push_back(x);
+        vm.inputs.push_back(y);
+        return run_program_19(vm) && vm.output == 1;
+    }
+
+    bool probe(const long x, const long y) {
+        if (x < 0 || y < 0) {
+            return false;
+        }
+
+        const auto [it, inserted] = cache.try_emplace(key(x, y), false);
+        if (inserted) {
+            it->second = run(x, y);
+            probes++;
+        }
+        return it->second;
+    }
+
+    // probe all points that are not cached yet, spread over all cores
+    void probe_batch(const vector<pair<long, long>>& points) {
+        vector<pair<long, long>> todo;
+        for (const auto& [x, y] : points) {
+            if (x >= 0 && y >= 0 && !cache.contains(key(x, y))) {
+                todo.emplace_back(x, y);
+            }
+        }
+
+        // a vector<bool> cannot be written from several threads
+        vector<char> results(todo.size(), 0);
+        atomic<size_t> next = 0;
+        vector<thread> workers;
+        for (size_t t = 0; t < min<size_t>(max(1u, thread::hardware_concurrency()), todo.size()); t++) {
+            workers.emplace_back([&] {
+                for (size_t i = next++; i < todo.size(); i = next++) {
+                    results[i] = run(todo[i].first, todo[i].second);
+                }
+            });
+        }
+        for (thread& w : workers) {
+            w.join();
+        }
+
+        for (size_t i = 0; i < todo.size(); i++) {
+            cache[key(todo[i].first, todo[i].second)] = results[i];
+        }
+        probes += todo.size();
+    }
+
+    // Left and right edge of row y. With a non-empty row above it, the edges are estimated by scaling that
+    // row (the beam is a cone from the origin) and then walked to the exact edge, which takes a few probes.
+    // Without one, the columns below width are scanned in a single batch. Row 0 only holds the origin, which
+    // is in every beam, so it says nothing about the slope and is not used for scaling.
+    pair<long, long> edges(const long y, const long width) {
+        if (const auto it = rows.find(y); it != rows.end()) {
+            return it->second;
+        }
+
+        // nearest non-empty row above
+        auto reference = rows.end();
+        for (auto it = rows.lower_bound(y); it != rows.begin();) {
+            --it;
+            if (it->first > 0 && it->second.first <= it->second.second) {
+                reference = it;
+                break;
+            }
+        }
+
+        pair<long, long> result = {1, 0};
+
+        if (reference == rows.end()) {
+            vector<pair<long, long>> points;
+            for (long x = 0; x < width; x++) {
+                points.emplace_back(x, y);
+            }
+            probe_batch(points);
+
+            long first = -1, last = -1;
+            for (long x = 0; x < width; x++) {
+                if (probe(x, y)) {
+                    first = first < 0 ? x : first;
+                    last = x;
+                }
+            }
+            // an empty scan is not kept, the beam may still lie beyond the width
+            if (first < 0) {
+                return result;
+            }
+            result = {first, last};
+        } else {
+            const auto [ry, edge] = *reference;
+            long left = edge.first * y / ry;
+            const long right_estimate = (edge.second + 1) * y / ry;
+
+            if (probe(left, y)) {
+                while (probe(left - 1, y)) {
+                    left--;
+                }
+            } else {
+                while (left <= right_estimate + 1 && !probe(left, y)) {
+                    left++;
+                }
+            }
+
+            if (probe(left, y)) {
+                long right = max(left, right_estimate);
+                if (probe(right, y)) {
+                    while (probe(right + 1, y)) {
+                        right++;
+                    }
+                } else {
+                    while (!probe(right, y)) {
+                        right--;
+                    }
+                }
+                result = {left, right};
+            }
+        }
+
+        rows[y] = result;
+        return result;
+    }
+
+    // points of the beam in the size x size square at the origin
+    long count(const long size) {
+        long result = 0;
+        for (long y = 0; y < size; y++) {
+            const auto [left, right] = edges(y, size);
+            if (left <= right && left < size) {
+                result += min(right, size - 1) - left + 1;
+            }
+        }
+        return result;
+    }
+
+    // whether a size x size square fits with its bottom left corner on the left edge of row y
+    bool fits(const long y, const long size, const long width) {
+        const auto [left, right] = edges(y, width);
+        return y >= size - 1 && left <= right && probe(left + size - 1, y - size + 1);
+    }
+
+    // Closest square of size x size in the beam, as the top left corner, {-1, -1} if the beam cannot be found.
+    // The first row it can fit on is scanned over a doubling width until it has part of the beam, all rows
+    // after it are found by scaling. Whether the square fits is only roughly monotone in the bottom row, the
+    // rounding of the edges can make it fit on one row and not on the next. A gallop and binary search find
+    // a row lo where it does not fit next to one where it does. The rounding moves both edges by less than
+    // one column, so no row more than 2 / (right slope - left slope) before lo can fit, and the rows from
+    // there on are scanned one by one for the first fit.
+    pair<long, long> closest_square(const long size) {
+        constexpr long max_width = 1 << 16;
+        long width = size;
+        for (pair<long, long> row = edges(size - 1, width); row.first > row.second; row = edges(size - 1, width)) {
+            if (width > max_width) {
+                cerr << "No beam in the first " << max_width << " columns of row " << size - 1 << endl;
+                return {-1, -1};
+            }
+            width *= 2;
+        }
+
+        constexpr long max_rows = 1 << 24;
+        long lo = size - 1;  // does not fit (or the first row to try)
+        long hi = size;
+        while (!fits(hi, size, width)) {
+            if (hi > max_rows) {
+                cerr << "No square of size " << size << " in the first " << max_rows << " rows of the beam" << endl;
+                return {-1, -1};
+            }
+            lo = hi;
+            hi *= 2;
+        }
+
+        while (hi - lo > 1) {
+            const long mid = lo + (hi - lo) / 2;
+            if (fits(mid, size, width)) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+
+        // the width of row hi over hi underestimates the difference of the slopes by at most 2 / hi
+        const auto [left, right] = edges(hi, width);
+        const long margin = 2 * hi / max(1L, right - left) + 1;
+        long y = max(size - 1, lo - margin);
+        while (!fits(y, size, width)) {
+            y++;
+        }
+
+        return {edges(y, width).first, y - size + 1};
+    }
+} TractorBeam;
+
+// Main function of this file
 void Day19::execute(const vector<string>& lines) {
+    // gathering input and putting it into an array
+    vector<long> input;
+
+    stringstream ss(lines.front());
+    string interim_result;
+
+    while (getline(ss, interim_result, ',')) {
+        input.push_back(stol(interim_result));
+    }
+    // end gathering input
+
+    TractorBeam beam(input);
+
+    cout << "Part 1: " << beam.count(50) << endl;
+
+    const auto [x, y] = beam.closest_square(100);
+    if (x < 0) {
+        return;
+    }
+    cout << "Part 2: " << x * 10000 + y << endl;
+}
+
+// whether the next instruction is an input while no input is queued
+bool needs_input_19(const VM &vm) {
+    return !vm.halted && vm.tape[vm.pc] % 100 == INPUT && vm.inputs.empty();
+}
+
+// runs until an output, input starvation or halt, returns whether it stopped on an output
+bool run_program_19(VM &vm) {
+    // if this does not run anymore
+    if (vm.halted) {
+        return false;
+    }
+
+    vm.paused = false;
+
+    // whilst we can do operations
+    while (vm.pc < vm.tape.size()) {
+        // pause until the host provides input
+        if (needs_input_19(vm)) {
+            vm.paused = true;
+            return false;
+        }
+
+        // fetch and run the instruction
+        IntCode instruction = read_instruction_19(vm);
+
+
+        run_instruction_19(vm, instruction);
+
+        // we stop once there is a halting or pausing occurring
+        if (vm.halted || vm.paused) {
+            break;
+        }
+
+    }
+
+    return vm.paused && !vm.halted;
+}
+
+// converts 5-digit number to array
+std::array<int, 5> to_array_19(int n) {
+    std::array result = {0,0,0,0,0};
+
+    for (int i = 4; i >= 0; i--) {
+        const int right = n % 10;
+        result[i] = right;
+        n /= 10;
+    }
+
+    return result;
+}
+
+IntCode read_instruction_19(const VM &vm) {
+    IntCode instruction;
+    instruction.modes_n_opcode = vm.tape[vm.pc];
+    const std::array<int, 5> modes_n_opcode = to_array_19(vm.tape[vm.pc]);
+
+    // read the parameter modes
+    instruction.mode_a = modes_n_opcode[2];
+    instruction.mode_b = modes_n_opcode[1];
+    instruction.mode_c = modes_n_opcode[0];
+
+    instruction.op_code = modes_n_opcode[3] * 10 + modes_n_opcode[4];
+
+    switch (instruction.op_code) {
+        // these all do the same in terms of arguments
+        case ADD:
+        case MULT:
+        case LESS_THAN:
+        case EQUALS:
+            instruction.offset = 4;
+            // first and second arguments based on instruction mode
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            if (instruction.mode_b == IMMEDIATE) {
+                instruction.b = vm.tape[vm.pc + 2];
+            } else if (instruction.mode_b == RELATIVE) {
+                instruction.b = vm.tape[vm.tape[vm.pc + 2] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_b == POSITION);
+                instruction.b = vm.tape[vm.tape[vm.pc + 2]];
+            }
+
+            if (instruction.mode_c == RELATIVE) {
+                instruction.c = vm.tape[vm.pc + 3] + vm.relative_offset;
+            } else {
+                assert(instruction.mode_c == POSITION); // cannot be immediate mode
+                instruction.c = vm.tape[vm.pc + 3];
+            }
+
+            break;
+            // Input output
+        case INPUT:
+            instruction.offset = 2;
+
+            if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.pc + 1] + vm.relative_offset;
+            } else {
+                assert(instruction.mode_a == POSITION); // cannot be immediate mode
+                instruction.a = vm.tape[vm.pc + 1];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case OUTPUT:
+            instruction.offset = 2;
+
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case RELATIVE_ADJUST:
+            instruction.offset = 2;
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case JUMP_FALSE:
+        case JUMP_TRUE:
+            instruction.offset = 3;
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            if (instruction.mode_b == IMMEDIATE) {
+                instruction.b = vm.tape[vm.pc + 2];
+            } else if (instruction.mode_b == RELATIVE) {
+                instruction.b = vm.tape[vm.tape[vm.pc + 2] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_b == POSITION);
+                instruction.b = vm.tape[vm.tape[vm.pc + 2]];
+            }
+
+            instruction.c = -1; // not used
+            break;
+        case END:
+            instruction.offset = 1;
+            instruction.a = -1; // not used
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        default:
+            assert(false);
+    }
+
+    return instruction;
+}
+
+void run_instruction_19(VM &vm, IntCode const &instruction) {
+    // if not a valid opcode
+    if (instruction.op_code != ADD && instruction.op_code != MULT &&
+        instruction.op_code != INPUT && instruction.op_code != OUTPUT &&
+        instruction.op_code != JUMP_FALSE && instruction.op_code != JUMP_TRUE &&
+        instruction.op_code != LESS_THAN && instruction.op_code != EQUALS && instruction.op_code != END &&
+        instruction.op_code != RELATIVE_ADJUST) {
+        std::cout << "Invalid op_code = " << instruction.op_code << std::endl;
+        std::cout << vm.tape[vm.pc] << "," << vm.tape[vm.pc + 1] << "," << vm.tape[vm.pc + 2] << "," << vm.tape[vm.pc + 3] << std::endl;
+
+        // program counter to the end and halt
+        vm.pc = vm.tape.size();
+        vm.halted = true;
+        return;
+    }
+
+    long result;
+    const long a = instruction.a;
+    const long b = instruction.b;
+    const long c = instruction.c;
+
+    // do the operation
+    switch (instruction.op_code) {
+        case ADD:
+            // add
+            result = a + b;
+            vm.tape[c] = result;
+            break;
+        case MULT:
+            // multiply
+            result = a * b;
+            vm.tape[c] = result;
+            break;
+        case INPUT:
+            // take input, if there is any
+            assert(!vm.inputs.empty());
+            vm.tape[a] = vm.inputs.front();
+            vm.inputs.pop_front();
+            break;
+        case OUTPUT:
+            // output pauses so that it can be retrieved
+            vm.output = a;
+            vm.paused = true;
+            break;
+        case JUMP_FALSE:
+            if (a == 0) {
+                vm.pc = b;
+                return;
+            }
+            break;
+        case JUMP_TRUE:
+            if (a != 0) {
+                vm.pc = b;
+                return;
+            }
+            break;
+        case LESS_THAN:
+            vm.tape[c] = a < b ? 1 : 0;
+            break;
+        case EQUALS:
+            vm.tape[c] = a == b ? 1 : 0;
+            break;
+        case RELATIVE_ADJUST:
+            vm.relative_offset += a;
+            break;
+        case END:
+            vm.halted = true;
+            vm.pc = vm.tape.size();
+            return;
+        default:
+            // should not be anything else
+            assert(false);
+    }
+
+    vm.pc += instruction.offset;
+
 
-    cout << "Nothing done here yet " << endl;
-}
\ No newline at end of file
+}
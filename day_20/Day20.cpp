@@ -1,17 +1,217 @@
 #include "Day20.h"
 
 #include <algorithm>
-#include <cmath>
+#include <array>
+#include <climits>
+#include <deque>
+#include <functional>
 #include <iostream>
-#include <map>
 #include <queue>
-#include <set>
-#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
 
 using namespace std;
 
+// one end of a portal, on the open tile next to its label
+typedef struct PortalEnd {
+    string label;
+    int x;
+    int y;
+    bool outer;      // on the outer edge of the donut, leads one level up in the recursive variant
+    int partner;     // the other end of the portal, -1 for AA and ZZ
+} PortalEnd;
+
+// The donut maze collapsed into a weighted graph between the portal ends
+typedef struct DonutMaze {
+    vector<string> grid;
+    int width = 0;
+    int height = 0;
+    vector<PortalEnd> ends;
+    vector<vector<pair<int, int>>> walks;  // per end: (other end, steps) reachable without teleporting
+    int start = -1;                        // AA
+    int finish = -1;                       // ZZ
+
+    explicit DonutMaze(vector<string> map) : grid(std::move(map)) {
+        height = static_cast<int>(grid.size());
+        for (const string& row : grid) {
+            width = max(width, static_cast<int>(row.size()));
+        }
+
+        // a label is two letters next to each other, with an open tile directly before or after them
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                if (!isupper(at(x, y))) {
+                    continue;
+                }
+
+                for (const auto& [dx, dy] : {pair{1, 0}, pair{0, 1}}) {
+                    if (!isupper(at(x + dx, y + dy))) {
+                        continue;
+                    }
+
+                    const string label = {at(x, y), at(x + dx, y + dy)};
+                    int ox = x - dx, oy = y - dy;            // open tile before the label
+                    if (at(ox, oy) != '.') {
+                        ox = x + 2 * dx;                     // or after it
+                        oy = y + 2 * dy;
+                    }
+                    if (at(ox, oy) != '.') {
+                        continue;
+                    }
+
+                    const bool outer = ox == 2 || oy == 2 || ox == width - 3 || oy == height - 3;
+                    ends.push_back({label, ox, oy, outer, -1});
+                }
+            }
+        }
+
+        // pair up the ends with the same label
+        for (int i = 0; i < static_cast<int>(ends.size()); i++) {
+            if (ends[i].label == "AA") {
+                start = i;
+            } else if (ends[i].label == "ZZ") {
+                finish = i;
+            }
+
+            for (int j = 0; j < i; j++) {
+                if (ends[j].label == ends[i].label) {
+                    ends[i].partner = j;
+                    ends[j].partner = i;
+                }
+            }
+        }
+
+        for (int i = 0; i < static_cast<int>(ends.size()); i++) {
+            walks.push_back(bfs(i));
+        }
+    }
+
+    [[nodiscard]] char at(const int x, const int y) const {
+        if (y < 0 || y >= height || x < 0 || x >= static_cast<int>(grid[y].size())) {
+            return ' ';
+        }
+        return grid[y][x];
+    }
+
+    // one BFS over the open tiles from a portal end to all other ends
+    [[nodiscard]] vector<pair<int, int>> bfs(const int from) const {
+        constexpr array<int, 4> dx = {0, 0, -1, 1};
+        constexpr array<int, 4> dy = {-1, 1, 0, 0};
+
+        vector<int> steps(static_cast<size_t>(width) * height, -1);
+        deque<pair<int, int>> queue = {{ends[from].x, ends[from].y}};
+        steps[ends[from].y * width + ends[from].x] = 0;
+
+        while (!queue.empty()) {
+            const auto [x, y] = queue.front();
+            queue.pop_front();
+
+            for (size_t d = 0; d < dx.size(); d++) {
+                const int nx = x + dx[d];
+                const int ny = y + dy[d];
+                if (at(nx, ny) != '.' || steps[ny * width + nx] >= 0) {
+                    continue;
+                }
+                steps[ny * width + nx] = steps[y * width + x] + 1;
+                queue.emplace_back(nx, ny);
+            }
+        }
+
+        vector<pair<int, int>> result;
+        for (int i = 0; i < static_cast<int>(ends.size()); i++) {
+            const int s = steps[ends[i].y * width + ends[i].x];
+            if (i != from && s > 0) {
+                result.emplace_back(i, s);
+            }
+        }
+        return result;
+    }
+
+    // Fewest steps from AA to ZZ, Dijkstra over (portal end, depth). Without recursion the depth stays 0.
+    // In the recursive variant inner portals go one level down and outer ones one up, outer portals are
+    // walls on the outermost level, AA and ZZ only exist there and the depth is bounded by max_depth.
+    [[nodiscard]] long shortest_path(const bool recursive, const int max_depth) const {
+        const int levels = recursive ? max_depth + 1 : 1;
+        vector<long> best(ends.size() * levels, LONG_MAX);
+        priority_queue<tuple<long, int, int>, vector<tuple<long, int, int>>, greater<>> queue;
+
+        best[start] = 0;
+        queue.emplace(0, start, 0);
+
+        while (!queue.empty()) {
+            const auto [distance, end, depth] = queue.top();
+            queue.pop();
+
+            if (distance > best[depth * ends.size() + end]) {
+                continue;
+            }
+            if (end == finish && depth == 0) {
+                return distance;
+            }
+
+            const auto relax = [&](const int next, const int next_depth, const long next_distance) {
+                long& b = best[next_depth * ends.size() + next];
+                if (next_distance < b) {
+                    b = next_distance;
+                    queue.emplace(next_distance, next, next_depth);
+                }
+            };
+
+            // walk to another end on this level
+            for (const auto& [next, steps] : walks[end]) {
+                relax(next, depth, distance + steps);
+            }
+
+            // or teleport
+            const int partner = ends[end].partner;
+            if (partner < 0) {
+                continue;
+            }
+            if (!recursive) {
+                relax(partner, 0, distance + 1);
+            } else {
+                const int next_depth = ends[end].outer ? depth - 1 : depth + 1;
+                if (next_depth >= 0 && next_depth <= max_depth) {
+                    relax(partner, next_depth, distance + 1);
+                }
+            }
+        }
+
+        return -1;
+    }
+} DonutMaze;
+
 void Day20::execute(const vector<string>& lines) {
 
-    cout << "Nothing done here yet " << endl;
-}
+    const DonutMaze maze(lines);
+
+    if (maze.start < 0 || maze.finish < 0) {
+        cerr << "The maze should have both AA and ZZ" << endl;
+        return;
+    }
 
+    const long part_1 = maze.shortest_path(false, 0);
+    if (part_1 < 0) {
+        cerr << "There is no path from AA to ZZ" << endl;
+        return;
+    }
+    cout << "Part 1: " << part_1 << endl;
+
+    // A shortest path never needs to go deeper than inner ends times outer ends: a deeper one repeats a pair of
+    // (inner end taken on the way down, outer end taken on the way up) and the part between can be cut out.
+    // The search covers only ends times that many states, so it runs once with the full bound.
+    int inner = 0, outer = 0;
+    for (const PortalEnd& end : maze.ends) {
+        if (end.partner >= 0) {
+            (end.outer ? outer : inner)++;
+        }
+    }
+
+    const long part_2 = maze.shortest_path(true, max(1, inner * outer));
+    if (part_2 < 0) {
+        cerr << "There is no path from AA to ZZ through the recursive levels" << endl;
+        return;
+    }
+    cout << "Part 2: " << part_2 << endl;
+}
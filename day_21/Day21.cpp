@@ -1,15 +1,711 @@
 #include "Day21.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <optional>
 #include <sstream>
-#include <ostream>
-#include <deque>
-#include <map>
-#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
 
 using namespace std;
 
+// OpCode int
+typedef int OpCode;
+constexpr OpCode ADD = 1;
+constexpr OpCode MULT = 2;
+constexpr OpCode INPUT = 3;
+constexpr OpCode OUTPUT = 4;
+constexpr OpCode JUMP_TRUE = 5;
+constexpr OpCode JUMP_FALSE = 6;
+constexpr OpCode LESS_THAN = 7;
+constexpr OpCode EQUALS = 8;
+constexpr OpCode RELATIVE_ADJUST = 9;
+constexpr OpCode END = 99;
+
+// ParameterMode int
+typedef int ParameterMode;
+constexpr ParameterMode POSITION = 0;
+constexpr ParameterMode IMMEDIATE = 1;
+constexpr ParameterMode RELATIVE = 2;
+
+// IntCode struct
+typedef struct IntCode {
+    long modes_n_opcode;     // The full int of the instruction
+    OpCode op_code;         // after deconstruction, the op_code
+    ParameterMode mode_a;   // after deconstruction, the mode of a
+    ParameterMode mode_b;   // after deconstruction, the mode of b
+    ParameterMode mode_c;   // after deconstruction, the mode of c
+    long a;                  // argument 1
+    long b;                  // argument 2
+    long c;                  // argument 3
+    int offset;             // offset depending on the opcode
+} IntCode;
+
+// VM struct
+typedef struct VM {
+    char tag;                   // identifier
+    size_t pc;                  // program counter
+    std::vector<long> tape;      // the program to work on
+    std::deque<long> inputs;     // the inputs given to the machine
+    long output;                 // an output of the machine
+    bool halted;                // halted or not
+    bool paused;                // paused or not
+    long relative_offset;
+
+    // constructor
+    VM(const char t, std::vector<long> program)
+        : tag(t), pc(0), tape(std::move(program)), output(0), halted(false), paused(false), relative_offset(0) {
+        tape.resize(tape.size() + 10000, 0); // add additional zeros for day 9
+    }
+} VM;
+
+// other defined functions
+bool needs_input_21(const VM &vm);
+bool run_program_21(VM &vm);
+IntCode read_instruction_21(const VM &vm);
+void run_instruction_21(VM &vm, IntCode const &instruction);
+long survey_21(const vector<long>& program, const string& mode, int sensors);
+
+// springscript instruction "op x y", x is a sensor (0 .. 8 for A .. I), T (9) or J (10), y is T (0) or J (1)
+typedef struct SpringInstruction {
+    int op;  // 0 AND, 1 OR, 2 NOT
+    int x;
+    int y;
+
+    [[nodiscard]] string text() const {
+        static const array<string, 3> ops = {"AND", "OR", "NOT"};
+        const char source = x < 9 ? static_cast<char>('A' + x) : x == 9 ? 'T' : 'J';
+        return ops[op] + " " + source + " " + (y == 0 ? 'T' : 'J');
+    }
+} SpringInstruction;
+
+// Open addressing set of (T, J) truth table pairs, stored back to back in an arena with the instruction that
+// produced them, sized once from a memory budget
+typedef struct SpringStateSet {
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    size_t stride;                                 // words per state, T followed by J
+    vector<uint64_t> arena;
+    vector<pair<uint32_t, uint16_t>> parents;      // (parent state, instruction) per state
+    vector<uint32_t> slots;
+    size_t mask;
+
+    SpringStateSet(const size_t stride, const size_t budget_bytes) : stride(stride) {
+        size_t capacity = 1024;
+        while (capacity * 2 * (sizeof(uint32_t) + stride * sizeof(uint64_t) + sizeof(parents[0])) <= budget_bytes) {
+            capacity *= 2;
+        }
+        slots.assign(capacity, EMPTY);
+        mask = capacity - 1;
+    }
+
+    [[nodiscard]] const uint64_t* state(const size_t s) const {
+        return arena.data() + s * stride;
+    }
+
+    [[nodiscard]] const uint64_t* jump(const size_t s) const {
+        return state(s) + stride / 2;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return parents.size();
+    }
+
+    // amount of states that fit below the load factor of 3/4
+    [[nodiscard]] size_t capacity() const {
+        return 3 * (mask + 1) / 4;
+    }
+
+    // slot of the state, or of the empty slot where it would go
+    [[nodiscard]] size_t find(const uint64_t* words) const {
+        uint64_t h = 0;
+        for (size_t i = 0; i < stride; i++) {
+            h = (h ^ words[i]) * 0x9E3779B97F4A7C15ULL;
+        }
+
+        size_t slot = h >> 20 & mask;
+        while (slots[slot] != EMPTY && !equal(words, words + stride, state(slots[slot]))) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    [[nodiscard]] bool contains(const uint64_t* words) const {
+        return slots[find(words)] != EMPTY;
+    }
+
+    // false if the state was already present
+    bool add(const uint64_t* words, const uint32_t parent, const uint16_t instruction) {
+        const size_t slot = find(words);
+        if (slots[slot] != EMPTY) {
+            return false;
+        }
+
+        slots[slot] = static_cast<uint32_t>(size());
+        arena.insert(arena.end(), words, words + stride);
+        parents.emplace_back(parent, instruction);
+        return true;
+    }
+} SpringStateSet;
+
+// Synthesizes springscript against the hull patterns the droid has fallen into so far.
+// The droid only ever sees a handful of distinct sensor windows, so a program is evaluated natively as truth
+// tables over those windows: one bitset for T and one for J, a bit per window. Whether J lets the droid cross
+// every known hull follows from the jump table alone, no VM is involved.
+typedef struct SpringSynthesizer {
+    int sensors;                         // 4 for WALK, 9 for RUN
+    vector<string> hulls;                // known patterns, '#' ground and '.' a hole, the droid starts on 0
+    vector<int> window_index;            // per sensor mask its window, -1 if not seen
+    vector<int> windows;                 // sensor mask per window, bit s set when sensor s sees ground
+    vector<vector<int>> window_at;       // per hull the window at every position the droid can stand on
+
+    explicit SpringSynthesizer(const int sensors) : sensors(sensors), window_index(1 << sensors, -1) {}
+
+    [[nodiscard]] static bool ground(const string& hull, const size_t i) {
+        return i >= hull.size() || hull[i] == '#';
+    }
+
+    // false if the pattern is already known
+    bool add_hull(const string& hull) {
+        if (find(hulls.begin(), hulls.end(), hull) != hulls.end()) {
+            return false;
+        }
+
+        vector<int> at(hull.size(), -1);
+        for (size_t pos = 0; pos < hull.size(); pos++) {
+            if (!ground(hull, pos)) {
+                continue;
+            }
+
+            int mask = 0;
+            for (int s = 0; s < sensors; s++) {
+                mask |= ground(hull, pos + 1 + s) << s;
+            }
+            if (window_index[mask] < 0) {
+                window_index[mask] = static_cast<int>(windows.size());
+                windows.push_back(mask);
+            }
+            at[pos] = window_index[mask];
+        }
+
+        hulls.push_back(hull);
+        window_at.push_back(std::move(at));
+        return true;
+    }
+
+    // whether the droid crosses all known hulls when it jumps on the windows set in the jump table
+    [[nodiscard]] bool survives(const uint64_t* jump) const {
+        for (size_t h = 0; h < hulls.size(); h++) {
+            for (size_t pos = 0; pos < hulls[h].size();) {
+                const int w = window_at[h][pos];
+                pos += jump[w >> 6] >> (w & 63) & 1 ? 4 : 1;
+                if (!ground(hulls[h], pos)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Shortest program of at most max_length instructions that crosses all known hulls. Breadth first over
+    // the (T, J) truth tables that the instructions can produce, programs giving the same tables are the
+    // same program as far as the known hulls go, so only the first of them is expanded. Every level is
+    // expanded on all cores against the states of the levels before it, then merged into the state set.
+    [[nodiscard]] optional<vector<SpringInstruction>> synthesize(const size_t max_length,
+                                                                 const size_t budget_bytes) const {
+        const size_t words = max<size_t>(1, (windows.size() + 63) / 64);
+        const size_t stride = 2 * words;
+        const uint64_t last_mask = windows.size() % 64 == 0 ? ~uint64_t{0} : (uint64_t{1} << windows.size() % 64) - 1;
+
+        // truth table of every sensor
+        vector<uint64_t> tables(sensors * words, 0);
+        for (size_t w = 0; w < windows.size(); w++) {
+            for (int s = 0; s < sensors; s++) {
+                if (windows[w] >> s & 1) {
+                    tables[s * words + (w >> 6)] |= uint64_t{1} << (w & 63);
+                }
+            }
+        }
+
+        vector<SpringInstruction> instructions;
+        for (int op = 0; op < 3; op++) {
+            for (int x = 0; x < 11; x++) {
+                if (x >= sensors && x < 9) {
+                    continue;
+                }
+                for (int y = 0; y < 2; y++) {
+                    instructions.push_back({op, x, y});
+                }
+            }
+        }
+
+        // applies an instruction to a state
+        const auto step = [&](const uint64_t* state, const SpringInstruction& in, uint64_t* next) {
+            copy(state, state + stride, next);
+            const uint64_t* x = in.x < 9 ? &tables[in.x * words] : state + (in.x - 9) * words;
+            uint64_t* y = next + in.y * words;
+            for (size_t i = 0; i < words; i++) {
+                switch (in.op) {
+                    case 0: y[i] &= x[i]; break;
+                    case 1: y[i] |= x[i]; break;
+                    default: y[i] = ~x[i]; break;
+                }
+            }
+            y[words - 1] &= last_mask;
+        };
+
+        // the empty program, T and J are false
+        SpringStateSet states(stride, budget_bytes);
+        states.add(vector<uint64_t>(stride, 0).data(), UINT32_MAX, 0);
+        if (survives(states.jump(0))) {
+            return vector<SpringInstruction>();
+        }
+
+        const size_t thread_count = max<size_t>(1, thread::hardware_concurrency());
+        const size_t thread_budget = states.capacity() / thread_count;
+        const size_t n = instructions.size();
+
+        // Expands the states in [begin, end) on all threads, with a solution returned as the instructions after
+        // the state numbered (state - begin) * n + instruction. New states are collected per thread until they
+        // run out of room. With lookahead nothing is collected, instead every new state is checked one
+        // instruction further, which is the last level the search can reach once the states no longer fit.
+        vector<vector<uint64_t>> found_states(thread_count);
+        vector<vector<pair<uint32_t, uint16_t>>> found_parents(thread_count);
+        atomic<bool> overflow = false;
+
+        const auto expand = [&](const size_t begin, const size_t end, const bool lookahead) {
+            vector<size_t> solutions(thread_count, SIZE_MAX);
+
+            vector<thread> workers;
+            for (size_t t = 0; t < thread_count; t++) {
+                found_states[t].clear();
+                found_parents[t].clear();
+
+                workers.emplace_back([&, t] {
+                    vector<uint64_t> next(stride), after(stride);
+                    for (size_t s = begin + t; s < end && solutions[t] == SIZE_MAX; s += thread_count) {
+                        for (size_t i = 0; i < n && solutions[t] == SIZE_MAX; i++) {
+                            step(states.state(s), instructions[i], next.data());
+                            if (states.contains(next.data())) {
+                                continue;
+                            }
+
+                            if (lookahead) {
+                                for (size_t j = 0; j < n; j++) {
+                                    step(next.data(), instructions[j], after.data());
+                                    if (!states.contains(after.data()) && survives(&after[words])) {
+                                        solutions[t] = ((s - begin) * n + i) * n + j;
+                                        break;
+                                    }
+                                }
+                                continue;
+                            }
+
+                            if (survives(&next[words])) {
+                                solutions[t] = (s - begin) * n + i;
+                            } else if (found_parents[t].size() < thread_budget) {
+                                found_states[t].insert(found_states[t].end(), next.begin(), next.end());
+                                found_parents[t].emplace_back(s, i);
+                            } else {
+                                // out of room the level is still checked for solutions, it just is not stored
+                                overflow = true;
+                            }
+                        }
+                    }
+                });
+            }
+            for (thread& w : workers) {
+                w.join();
+            }
+
+            // the lowest solution keeps the result independent of the amount of threads
+            return *min_element(solutions.begin(), solutions.end());
+        };
+
+        // the instructions leading up to a stored state and then the ones in the solution code
+        const auto script = [&](const size_t begin, size_t code, const size_t tail) {
+            vector<SpringInstruction> result;
+            for (size_t k = 0; k < tail; k++, code /= n) {
+                result.push_back(instructions[code % n]);
+            }
+            for (uint32_t s = begin + code; states.parents[s].first != UINT32_MAX; s = states.parents[s].first) {
+                result.push_back(instructions[states.parents[s].second]);
+            }
+            reverse(result.begin(), result.end());
+            return result;
+        };
+
+        size_t begin = 0, end = 1;
+        for (size_t length = 1; length <= max_length && begin < end; length++) {
+            const size_t solution = expand(begin, end, false);
+            if (solution != SIZE_MAX) {
+                return script(begin, solution, 1);
+            }
+
+            // the successors that are new to all threads form the next level, if they all fit
+            size_t found = 0;
+            for (const auto& parents : found_parents) {
+                found += parents.size();
+            }
+
+            if (overflow || states.size() + found > states.capacity()) {
+                if (length < max_length) {
+                    const size_t deeper = expand(begin, end, true);
+                    if (deeper != SIZE_MAX) {
+                        return script(begin, deeper, 2);
+                    }
+                }
+
+                cerr << "Out of the memory budget for springscript states" << endl;
+                return nullopt;
+            }
+
+            for (size_t t = 0; t < thread_count; t++) {
+                for (size_t i = 0; i < found_parents[t].size(); i++) {
+                    const auto& [parent, instruction] = found_parents[t][i];
+                    states.add(&found_states[t][i * stride], parent, instruction);
+                }
+            }
+
+            begin = end;
+            end = states.size();
+        }
+
+        return nullopt;
+    }
+} SpringSynthesizer;
+
+// Main function of this file
 void Day21::execute(const vector<string>& lines) {
+    // gathering input and putting it into an array
+    vector<long> input;
+
+    stringstream ss(lines.front());
+    string interim_result;
+
+    while (getline(ss, interim_result, ',')) {
+        input.push_back(stol(interim_result));
+    }
+    // end gathering input
+
+    // WALK senses four tiles ahead, RUN nine
+    const long walk = survey_21(input, "WALK", 4);
+    cout << "Part 1: " << walk << endl;
+
+    const long run = survey_21(input, "RUN", 9);
+    cout << "Part 2: " << run << endl;
+}
+
+// Hull damage reported by the droid for the mode, -1 if no script could be found. Scripts are synthesized
+// against the known hulls, only the final check of each one runs the VM. When the droid falls the hull it
+// fell into is taken from the output and the next script also has to cross that one.
+long survey_21(const vector<long>& program, const string& mode, const int sensors) {
+    constexpr size_t max_instructions = 15;
+    constexpr size_t budget = size_t{256} << 20;
+
+    SpringSynthesizer synthesizer(sensors);
+
+    while (true) {
+        const optional<vector<SpringInstruction>> script = synthesizer.synthesize(max_instructions, budget);
+        if (!script) {
+            cerr << "No springscript of at most " << max_instructions << " instructions crosses all hulls" << endl;
+            return -1;
+        }
+
+        string text;
+        for (const SpringInstruction& instruction : *script) {
+            text += instruction.text() + "\n";
+        }
+        text += mode + "\n";
+
+        VM vm('S', program);
+        for (const char c : text) {
+            vm.inputs.push_back(c);
+        }
+
+        string output;
+        while (run_program_21(vm)) {
+            // anything outside of ASCII is the hull damage
+            if (vm.output > 127) {
+                return vm.output;
+            }
+            output += static_cast<char>(vm.output);
+        }
+
+        // the hull is the first line of ground and holes after the droid fell
+        string hull;
+        stringstream frames(output.substr(min(output.size(), output.find("Didn't make it across"))));
+        for (string line; getline(frames, line);) {
+            if (!line.empty() && line.find('#') != string::npos && line.find_first_not_of("#.") == string::npos) {
+                hull = line;
+                break;
+            }
+        }
+
+        if (hull.empty() || !synthesizer.add_hull(hull)) {
+            cerr << "The droid fell without showing a new hull:" << endl << output;
+            return -1;
+        }
+    }
+}
+
+// whether the next instruction is an input while no input is queued
+bool needs_input_21(const VM &vm) {
+    return !vm.halted && vm.tape[vm.pc] % 100 == INPUT && vm.inputs.empty();
+}
+
+// runs until an output, input starvation or halt, returns whether it stopped on an output
+bool run_program_21(VM &vm) {
+    // if this does not run anymore
+    if (vm.halted) {
+        return false;
+    }
+
+    vm.paused = false;
+
+    // whilst we can do operations
+    while (vm.pc < vm.tape.size()) {
+        // pause until the host provides input
+        if (needs_input_21(vm)) {
+            vm.paused = true;
+            return false;
+        }
+
+        // fetch and run the instruction
+        IntCode instruction = read_instruction_21(vm);
+
+
+        run_instruction_21(vm, instruction);
+
+        // we stop once there is a halting or pausing occurring
+        if (vm.halted || vm.paused) {
+            break;
+        }
+
+    }
+
+    return vm.paused && !vm.halted;
+}
+
+// converts 5-digit number to array
+std::array<int, 5> to_array_21(int n) {
+    std::array result = {0,0,0,0,0};
+
+    for (int i = 4; i >= 0; i--) {
+        const int right = n % 10;
+        result[i] = right;
+        n /= 10;
+    }
+
+    return result;
+}
+
+IntCode read_instruction_21(const VM &vm) {
+    IntCode instruction;
+    instruction.modes_n_opcode = vm.tape[vm.pc];
+    const std::array<int, 5> modes_n_opcode = to_array_21(vm.tape[vm.pc]);
+
+    // read the parameter modes
+    instruction.mode_a = modes_n_opcode[2];
+    instruction.mode_b = modes_n_opcode[1];
+    instruction.mode_c = modes_n_opcode[0];
+
+    instruction.op_code = modes_n_opcode[3] * 10 + modes_n_opcode[4];
+
+    switch (instruction.op_code) {
+        // these all do the same in terms of arguments
+        case ADD:
+        case MULT:
+        case LESS_THAN:
+        case EQUALS:
+            instruction.offset = 4;
+            // first and second arguments based on instruction mode
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            if (instruction.mode_b == IMMEDIATE) {
+                instruction.b = vm.tape[vm.pc + 2];
+            } else if (instruction.mode_b == RELATIVE) {
+                instruction.b = vm.tape[vm.tape[vm.pc + 2] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_b == POSITION);
+                instruction.b = vm.tape[vm.tape[vm.pc + 2]];
+            }
+
+            if (instruction.mode_c == RELATIVE) {
+                instruction.c = vm.tape[vm.pc + 3] + vm.relative_offset;
+            } else {
+                assert(instruction.mode_c == POSITION); // cannot be immediate mode
+                instruction.c = vm.tape[vm.pc + 3];
+            }
+
+            break;
+            // Input output
+        case INPUT:
+            instruction.offset = 2;
+
+            if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.pc + 1] + vm.relative_offset;
+            } else {
+                assert(instruction.mode_a == POSITION); // cannot be immediate mode
+                instruction.a = vm.tape[vm.pc + 1];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case OUTPUT:
+            instruction.offset = 2;
+
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case RELATIVE_ADJUST:
+            instruction.offset = 2;
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case JUMP_FALSE:
+        case JUMP_TRUE:
+            instruction.offset = 3;
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            if (instruction.mode_b == IMMEDIATE) {
+                instruction.b = vm.tape[vm.pc + 2];
+            } else if (instruction.mode_b == RELATIVE) {
+                instruction.b = vm.tape[vm.tape[vm.pc + 2] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_b == POSITION);
+                instruction.b = vm.tape[vm.tape[vm.pc + 2]];
+            }
+
+            instruction.c = -1; // not used
+            break;
+        case END:
+            instruction.offset = 1;
+            instruction.a = -1; // not used
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        default:
+            assert(false);
+    }
+
+    return instruction;
+}
+
+void run_instruction_21(VM &vm, IntCode const &instruction) {
+    // if not a valid opcode
+    if (instruction.op_code != ADD && instruction.op_code != MULT &&
+        instruction.op_code != INPUT && instruction.op_code != OUTPUT &&
+        instruction.op_code != JUMP_FALSE && instruction.op_code != JUMP_TRUE &&
+        instruction.op_code != LESS_THAN && instruction.op_code != EQUALS && instruction.op_code != END &&
+        instruction.op_code != RELATIVE_ADJUST) {
+        std::cout << "Invalid op_code = " << instruction.op_code << std::endl;
+        std::cout << vm.tape[vm.pc] << "," << vm.tape[vm.pc + 1] << "," << vm.tape[vm.pc + 2] << "," << vm.tape[vm.pc + 3] << std::endl;
+
+        // program counter to the end and halt
+        vm.pc = vm.tape.size();
+        vm.halted = true;
+        return;
+    }
+
+    long result;
+    const long a = instruction.a;
+    const long b = instruction.b;
+    const long c = instruction.c;
+
+    // do the operation
+    switch (instruction.op_code) {
+        case ADD:
+            // add
+            result = a + b;
+            vm.tape[c] = result;
+            break;
+        case MULT:
+            // multiply
+            result = a * b;
+            vm.tape[c] = result;
+            break;
+        case INPUT:
+            // take input, if there is any
+            assert(!vm.inputs.empty());
+            vm.tape[a] = vm.inputs.front();
+            vm.inputs.pop_front();
+            break;
+        case OUTPUT:
+            // output pauses so that it can be retrieved
+            vm.output = a;
+            vm.paused = true;
+            break;
+        case JUMP_FALSE:
+            if (a == 0) {
+                vm.pc = b;
+                return;
+            }
+            break;
+        case JUMP_TRUE:
+            if (a != 0) {
+                vm.pc = b;
+                return;
+            }
+            break;
+        case LESS_THAN:
+            vm.tape[c] = a < b ? 1 : 0;
+            break;
+        case EQUALS:
+            vm.tape[c] = a == b ? 1 : 0;
+            break;
+        case RELATIVE_ADJUST:
+            vm.relative_offset += a;
+            break;
+        case END:
+            vm.halted = true;
+            vm.pc = vm.tape.size();
+            return;
+        default:
+            // should not be anything else
+            assert(false);
+    }
+
+    vm.pc += instruction.offset;
+
 
-    cout << "Nothing done here yet " << endl;
-}
\ No newline at end of file
+}
@@ -1,13 +1,138 @@
 #include "Day22.h"
 
+#include <charconv>
 #include <iostream>
-#include <map>
-#include <set>
-#include <sstream>
+#include <string>
+#include <utility>
 
 using namespace std;
 
+// Shuffle as the affine map from the position of a card before to its position after: x -> a * x + b (mod m).
+// Every technique is such a map and so is any composition of them, a whole shuffle collapses into one pair.
+typedef struct LinearShuffle {
+    long a;
+    long b;
+    long m;
+
+    // modular multiplication through 128 bits, deck sizes go well past 32 bits
+    [[nodiscard]] static long mul(const long x, const long y, const long m) {
+        return static_cast<long>(static_cast<__int128>(x) * y % m);
+    }
+
+    [[nodiscard]] static long mod(const long x, const long m) {
+        return (x % m + m) % m;
+    }
+
+    [[nodiscard]] static LinearShuffle identity(const long m) {
+        return {1, 0, m};
+    }
+
+    [[nodiscard]] static LinearShuffle new_stack(const long m) {
+        return {m - 1, m - 1, m};
+    }
+
+    [[nodiscard]] static LinearShuffle cut(const long n, const long m) {
+        return {1, mod(-n, m), m};
+    }
+
+    [[nodiscard]] static LinearShuffle increment(const long n, const long m) {
+        return {mod(n, m), 0, m};
+    }
+
+    // position of the card at position x before the shuffle
+    [[nodiscard]] long apply(const long x) const {
+        return (mul(a, mod(x, m), m) + b) % m;
+    }
+
+    // this shuffle followed by the other one
+    [[nodiscard]] LinearShuffle then(const LinearShuffle& other) const {
+        return {mul(other.a, a, m), (mul(other.a, b, m) + other.b) % m, m};
+    }
+
+    // this shuffle repeated times times, by squaring
+    [[nodiscard]] LinearShuffle repeat(long times) const {
+        LinearShuffle result = identity(m);
+        LinearShuffle square = *this;
+
+        while (times > 0) {
+            if (times & 1) {
+                result = result.then(square);
+            }
+            square = square.then(square);
+            times >>= 1;
+        }
+
+        return result;
+    }
+
+    // the shuffle that undoes this one, a must be coprime with the deck size
+    [[nodiscard]] LinearShuffle inverse() const {
+        // extended euclid for the inverse of a
+        long old_r = a, r = m;
+        long old_s = 1, s = 0;
+        while (r != 0) {
+            const long q = old_r / r;
+            old_r -= q * r;
+            swap(old_r, r);
+            old_s -= q * s;
+            swap(old_s, s);
+        }
+
+        if (old_r != 1) {
+            cerr << "The shuffle cannot be undone for a deck of " << m << " cards" << endl;
+            return identity(m);
+        }
+
+        // x = a^-1 * (y - b)
+        const long inverse_a = mod(old_s, m);
+        return {inverse_a, mod(-mul(inverse_a, b, m), m), m};
+    }
+} LinearShuffle;
+
+// other defined functions
+LinearShuffle parse_shuffle_22(const vector<string>& lines, long deck);
+
 void Day22::execute(const vector<string>& lines) {
 
-    cout << "Nothing done here yet " << endl;
-}
\ No newline at end of file
+    constexpr long small_deck = 10007;
+    const long part_1 = parse_shuffle_22(lines, small_deck).apply(2019);
+    cout << "Part 1: " << part_1 << endl;
+
+    // the card that ends up at a position is found by undoing all the shuffles from that position
+    constexpr long huge_deck = 119315717514047;
+    constexpr long shuffles = 101741582076661;
+    const LinearShuffle all = parse_shuffle_22(lines, huge_deck).repeat(shuffles);
+    cout << "Part 2: " << all.inverse().apply(2020) << endl;
+}
+
+// the techniques in order, composed into a single shuffle for the deck size
+LinearShuffle parse_shuffle_22(const vector<string>& lines, const long deck) {
+    LinearShuffle shuffle = LinearShuffle::identity(deck);
+
+    for (const string& raw : lines) {
+        // trailing whitespace such as a carriage return is not part of the technique
+        const string line = raw.substr(0, raw.find_last_not_of(" \t\r") + 1);
+        if (line.empty()) {
+            continue;
+        }
+
+        // the argument is the last word
+        const size_t space = line.find_last_of(' ');
+        long argument = 0;
+        const char* begin = line.data() + space + 1;
+        const auto [end, error] = from_chars(begin, line.data() + line.size(), argument);
+        const bool has_argument = space != string::npos && error == errc() && end == line.data() + line.size();
+
+        if (line == "deal into new stack") {
+            shuffle = shuffle.then(LinearShuffle::new_stack(deck));
+        } else if (line.starts_with("cut ") && has_argument) {
+            shuffle = shuffle.then(LinearShuffle::cut(argument, deck));
+        } else if (line.starts_with("deal with increment ") && has_argument) {
+            shuffle = shuffle.then(LinearShuffle::increment(argument, deck));
+        } else {
+            cerr << "Unknown technique: " << line << endl;
+        }
+    }
+
+    return shuffle;
+}
@@ -1,16 +1,665 @@
 #include "Day23.h"
 
 #include <algorithm>
-#include <climits>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <mutex>
 #include <sstream>
-#include <map>
-#include <ostream>
-#include <set>
+#include <thread>
 
 using namespace std;
 
+// OpCode int
+typedef int OpCode;
+constexpr OpCode ADD = 1;
+constexpr OpCode MULT = 2;
+constexpr OpCode INPUT = 3;
+constexpr OpCode OUTPUT = 4;
+constexpr OpCode JUMP_TRUE = 5;
+constexpr OpCode JUMP_FALSE = 6;
+constexpr OpCode LESS_THAN = 7;
+constexpr OpCode EQUALS = 8;
+constexpr OpCode RELATIVE_ADJUST = 9;
+constexpr OpCode END = 99;
+
+// ParameterMode int
+typedef int ParameterMode;
+constexpr ParameterMode POSITION = 0;
+constexpr ParameterMode IMMEDIATE = 1;
+constexpr ParameterMode RELATIVE = 2;
+
+// IntCode struct
+typedef struct IntCode {
+    long modes_n_opcode;     // The full int of the instruction
+    OpCode op_code;         // after deconstruction, the op_code
+    ParameterMode mode_a;   // after deconstruction, the mode of a
+    ParameterMode mode_b;   // after deconstruction, the mode of b
+    ParameterMode mode_c;   // after deconstruction, the mode of c
+    long a;                  // argument 1
+    long b;                  // argument 2
+    long c;                  // argument 3
+    int offset;             // offset depending on the opcode
+} IntCode;
+
+// VM struct
+typedef struct VM {
+    char tag;                   // identifier
+    size_t pc;                  // program counter
+    std::vector<long> tape;      // the program to work on
+    std::deque<long> inputs;     // the inputs given to the machine
+    long output;                 // an output of the machine
+    bool halted;                // halted or not
+    bool paused;                // paused or not
+    long relative_offset;
+
+    // constructor
+    VM(const char t, std::vector<long> program)
+        : tag(t), pc(0), tape(std::move(program)), output(0), halted(false), paused(false), relative_offset(0) {
+        tape.resize(tape.size() + 10000, 0); // add additional zeros for day 9
+    }
+} VM;
+
+// other defined functions
+bool needs_input_23(const VM &vm);
+bool run_program_23(VM &vm);
+IntCode read_instruction_23(const VM &vm);
+void run_instruction_23(VM &vm, IntCode const &instruction);
+
+// packet on the network
+typedef struct Packet {
+    long x;
+    long y;
+} Packet;
+
+// Network interface controller, a VM with the packets queued for it and its half written packet
+typedef struct Nic {
+    VM vm;
+    deque<Packet> queue;
+    vector<long> out;
+    int empty_polls = 0;    // polls for input in a row that found nothing, with nothing sent in between
+
+    Nic(const long address, const vector<long>& program) : vm('N', program) {
+        vm.inputs.push_back(address);
+    }
+
+    // two empty polls without sending anything, the NIC waits for packets. A halted NIC never sends again.
+    [[nodiscard]] bool idle() const {
+        return vm.halted || empty_polls >= 2;
+    }
+
+    // feeds the next packet or -1 and runs until the NIC waits for input again, returns whether a packet was fed
+    template<typename Send>
+    bool step(const Send& send) {
+        if (vm.halted) {
+            return false;
+        }
+
+        const bool fed = !queue.empty();
+        if (fed) {
+            vm.inputs.push_back(queue.front().x);
+            vm.inputs.push_back(queue.front().y);
+            queue.pop_front();
+            empty_polls = 0;
+        } else {
+            vm.inputs.push_back(-1);
+            empty_polls++;
+        }
+
+        while (run_program_23(vm)) {
+            out.push_back(vm.output);
+            if (out.size() == 3) {
+                send(out[0], Packet{out[1], out[2]});
+                out.clear();
+                empty_polls = 0;
+            }
+        }
+
+        return fed;
+    }
+} Nic;
+
+// Inbox with many senders and a single receiver, without locks. Senders push onto an atomic list, the receiver
+// takes the whole list at once and reverses it back into the order of arrival.
+typedef struct Inbox {
+    typedef struct Entry {
+        Packet packet;
+        Entry* next;
+    } Entry;
+
+    atomic<Entry*> head = nullptr;
+
+    Inbox() = default;
+    Inbox(const Inbox&) = delete;
+    Inbox& operator=(const Inbox&) = delete;
+
+    ~Inbox() {
+        deque<Packet> rest;
+        drain(rest);
+    }
+
+    void push(const Packet& packet) {
+        auto* entry = new Entry{packet, head.load(memory_order_relaxed)};
+        while (!head.compare_exchange_weak(entry->next, entry, memory_order_release, memory_order_relaxed)) {}
+    }
+
+    // moves all packets into the queue, returns the amount
+    size_t drain(deque<Packet>& queue) {
+        Entry* entry = head.exchange(nullptr, memory_order_acquire);
+
+        Entry* reversed = nullptr;
+        while (entry != nullptr) {
+            Entry* next = entry->next;
+            entry->next = reversed;
+            reversed = entry;
+            entry = next;
+        }
+
+        size_t amount = 0;
+        while (reversed != nullptr) {
+            Entry* next = reversed->next;
+            queue.push_back(reversed->packet);
+            delete reversed;
+            reversed = next;
+            amount++;
+        }
+        return amount;
+    }
+} Inbox;
+
+// the Y of the first packet sent to the NAT and the first Y it delivers to NIC 0 twice in a row, -1 if never
+typedef struct NetworkResult {
+    long first_nat_y = -1;
+    long repeated_nat_y = -1;
+} NetworkResult;
+
+// other defined functions
+NetworkResult run_round_robin_23(const vector<long>& program, size_t nodes);
+NetworkResult run_threaded_23(const vector<long>& program, size_t nodes);
+
+// Main function of this file
 void Day23::execute(const vector<string>& lines) {
+    // gathering input and putting it into an array
+    vector<long> input;
+
+    stringstream ss(lines.front());
+    string interim_result;
+
+    while (getline(ss, interim_result, ',')) {
+        input.push_back(stol(interim_result));
+    }
+    // end gathering input
+
+    // AOC_THREADED runs the NICs on all cores, AOC_NODES changes the size of the network
+    const size_t nodes = getenv("AOC_NODES") != nullptr ? stoul(getenv("AOC_NODES")) : 50;
+    if (nodes == 0 || nodes >= 255) {
+        cerr << "The network needs between 1 and 254 NICs, address 255 is the NAT" << endl;
+        return;
+    }
+    const NetworkResult result = getenv("AOC_THREADED") != nullptr ? run_threaded_23(input, nodes)
+                                                                   : run_round_robin_23(input, nodes);
+
+    cout << "Part 1: " << result.first_nat_y << endl;
+    cout << "Part 2: " << result.repeated_nat_y << endl;
+}
+
+// Deterministic scheduler, every round each NIC gets one packet or -1 and runs until it waits for input again.
+// The network is idle after a round in which no NIC had a packet queued and none was sent.
+NetworkResult run_round_robin_23(const vector<long>& program, const size_t nodes) {
+    NetworkResult result;
+
+    vector<Nic> nics;
+    nics.reserve(nodes);
+    for (size_t a = 0; a < nodes; a++) {
+        nics.emplace_back(static_cast<long>(a), program);
+    }
+
+    Packet nat = {0, 0};
+    bool nat_filled = false;
+    bool delivered = false;
+    long last_delivered = 0;
+    bool busy = false;
+
+    const auto send = [&](const long address, const Packet& packet) {
+        busy = true;
+        if (address == 255) {
+            nat = packet;
+            nat_filled = true;
+            if (result.first_nat_y < 0) {
+                result.first_nat_y = packet.y;
+            }
+        } else if (address >= 0 && address < static_cast<long>(nodes)) {
+            nics[address].queue.push_back(packet);
+        }
+    };
+
+    while (true) {
+        busy = false;
+        size_t halted = 0;
+
+        for (Nic& nic : nics) {
+            if (nic.step(send)) {
+                busy = true;
+            }
+            halted += nic.vm.halted;
+        }
+
+        if (halted == nodes) {
+            cerr << "All NICs halted" << endl;
+            return result;
+        }
+        if (busy) {
+            continue;
+        }
+
+        // the network is idle, the NAT wakes up NIC 0
+        if (!nat_filled) {
+            cerr << "The network is idle before the NAT received a packet" << endl;
+            return result;
+        }
+        if (delivered && nat.y == last_delivered) {
+            result.repeated_nat_y = nat.y;
+            return result;
+        }
+
+        nics[0].queue.push_back(nat);
+        last_delivered = nat.y;
+        delivered = true;
+    }
+}
+
+// Scheduler on all cores, every thread owns a fixed share of the NICs and passes over them until stopped.
+// Packets go through the lock free inboxes. The network is idle by quiescence counting: all NICs idle and no
+// packet in flight, and still so with no activity at all after every thread made two more full passes.
+NetworkResult run_threaded_23(const vector<long>& program, const size_t nodes) {
+    NetworkResult result;
+
+    const size_t thread_count = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), nodes));
+
+    vector<Inbox> inboxes(nodes);
+    atomic<long> in_flight = 0;       // sent but not yet fed to a NIC
+    atomic<size_t> idle_nics = 0;
+    atomic<size_t> halted_nics = 0;
+    atomic<uint64_t> activity = 0;    // packets sent
+    atomic<bool> stop = false;
+    vector<atomic<uint64_t>> passes(thread_count);
+
+    // the NAT is only touched when something is sent to 255 or the network is idle
+    mutex nat_lock;
+    Packet nat = {0, 0};
+    bool nat_filled = false;
+
+    const auto send = [&](const long address, const Packet& packet) {
+        activity++;
+        if (address == 255) {
+            const lock_guard guard(nat_lock);
+            nat = packet;
+            nat_filled = true;
+            if (result.first_nat_y < 0) {
+                result.first_nat_y = packet.y;
+            }
+        } else if (address >= 0 && address < static_cast<long>(nodes)) {
+            in_flight++;
+            inboxes[address].push(packet);
+        }
+    };
+
+    vector<thread> workers;
+    for (size_t t = 0; t < thread_count; t++) {
+        workers.emplace_back([&, t] {
+            vector<Nic> nics;
+            vector<bool> counted;      // whether the NIC is counted in idle_nics
+            vector<bool> stopped;      // whether the NIC is counted in halted_nics
+            for (size_t a = t; a < nodes; a += thread_count) {
+                nics.emplace_back(static_cast<long>(a), program);
+                counted.push_back(false);
+                stopped.push_back(false);
+            }
+
+            while (!stop.load(memory_order_relaxed)) {
+                for (size_t i = 0; i < nics.size(); i++) {
+                    Nic& nic = nics[i];
+                    inboxes[t + i * thread_count].drain(nic.queue);
+                    if (nic.vm.halted && !nic.queue.empty()) {
+                        // packets for a halted NIC are dropped, they would stay in flight forever
+                        in_flight -= static_cast<long>(nic.queue.size());
+                        nic.queue.clear();
+                    }
+                    if (nic.step(send)) {
+                        in_flight--;
+                    }
+
+                    if (nic.idle() != counted[i]) {
+                        counted[i] = nic.idle();
+                        counted[i] ? idle_nics++ : idle_nics--;
+                    }
+                    if (nic.vm.halted && !stopped[i]) {
+                        stopped[i] = true;
+                        halted_nics++;
+                    }
+                }
+
+                passes[t]++;
+                if (nics.empty()) {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+
+    const auto quiet = [&] {
+        return idle_nics == nodes && in_flight == 0;
+    };
+
+    // the NAT runs on this thread
+    bool delivered = false;
+    long last_delivered = 0;
+
+    while (!stop) {
+        if (halted_nics == nodes) {
+            cerr << "All NICs halted" << endl;
+            break;
+        }
+        if (!quiet()) {
+            this_thread::yield();
+            continue;
+        }
+
+        // idle only when nothing happened while every thread passed over all of its NICs twice more
+        const uint64_t before = activity;
+        vector<uint64_t> targets;
+        for (const atomic<uint64_t>& p : passes) {
+            targets.push_back(p + 2);
+        }
+        for (size_t t = 0; t < thread_count; t++) {
+            while (passes[t] < targets[t] && !stop) {
+                this_thread::yield();
+            }
+        }
+        if (activity != before || !quiet()) {
+            continue;
+        }
+
+        const lock_guard guard(nat_lock);
+        if (!nat_filled) {
+            cerr << "The network is idle before the NAT received a packet" << endl;
+            break;
+        }
+        if (delivered && nat.y == last_delivered) {
+            result.repeated_nat_y = nat.y;
+            break;
+        }
+
+        in_flight++;
+        activity++;
+        inboxes[0].push(nat);
+        last_delivered = nat.y;
+        delivered = true;
+    }
+
+    stop = true;
+    for (thread& w : workers) {
+        w.join();
+    }
+
+    return result;
+}
+
+// whether the next instruction is an input while no input is queued
+bool needs_input_23(const VM &vm) {
+    return !vm.halted && vm.tape[vm.pc] % 100 == INPUT && vm.inputs.empty();
+}
+
+// runs until an output, input starvation or halt, returns whether it stopped on an output
+bool run_program_23(VM &vm) {
+    // if this does not run anymore
+    if (vm.halted) {
+        return false;
+    }
+
+    vm.paused = false;
+
+    // whilst we can do operations
+    while (vm.pc < vm.tape.size()) {
+        // pause until the host provides input
+        if (needs_input_23(vm)) {
+            vm.paused = true;
+            return false;
+        }
+
+        // fetch and run the instruction
+        IntCode instruction = read_instruction_23(vm);
+
+
+        run_instruction_23(vm, instruction);
+
+        // we stop once there is a halting or pausing occurring
+        if (vm.halted || vm.paused) {
+            break;
+        }
+
+    }
+
+    return vm.paused && !vm.halted;
+}
+
+// converts 5-digit number to array
+std::array<int, 5> to_array_23(int n) {
+    std::array result = {0,0,0,0,0};
+
+    for (int i = 4; i >= 0; i--) {
+        const int right = n % 10;
+        result[i] = right;
+        n /= 10;
+    }
+
+    return result;
+}
+
+IntCode read_instruction_23(const VM &vm) {
+    IntCode instruction;
+    instruction.modes_n_opcode = vm.tape[vm.pc];
+    const std::array<int, 5> modes_n_opcode = to_array_23(vm.tape[vm.pc]);
+
+    // read the parameter modes
+    instruction.mode_a = modes_n_opcode[2];
+    instruction.mode_b = modes_n_opcode[1];
+    instruction.mode_c = modes_n_opcode[0];
+
+    instruction.op_code = modes_n_opcode[3] * 10 + modes_n_opcode[4];
+
+    switch (instruction.op_code) {
+        // these all do the same in terms of arguments
+        case ADD:
+        case MULT:
+        case LESS_THAN:
+        case EQUALS:
+            instruction.offset = 4;
+            // first and second arguments based on instruction mode
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            if (instruction.mode_b == IMMEDIATE) {
+                instruction.b = vm.tape[vm.pc + 2];
+            } else if (instruction.mode_b == RELATIVE) {
+                instruction.b = vm.tape[vm.tape[vm.pc + 2] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_b == POSITION);
+                instruction.b = vm.tape[vm.tape[vm.pc + 2]];
+            }
+
+            if (instruction.mode_c == RELATIVE) {
+                instruction.c = vm.tape[vm.pc + 3] + vm.relative_offset;
+            } else {
+                assert(instruction.mode_c == POSITION); // cannot be immediate mode
+                instruction.c = vm.tape[vm.pc + 3];
+            }
+
+            break;
+            // Input output
+        case INPUT:
+            instruction.offset = 2;
+
+            if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.pc + 1] + vm.relative_offset;
+            } else {
+                assert(instruction.mode_a == POSITION); // cannot be immediate mode
+                instruction.a = vm.tape[vm.pc + 1];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case OUTPUT:
+            instruction.offset = 2;
+
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case RELATIVE_ADJUST:
+            instruction.offset = 2;
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        case JUMP_FALSE:
+        case JUMP_TRUE:
+            instruction.offset = 3;
+            if (instruction.mode_a == IMMEDIATE) {
+                instruction.a = vm.tape[vm.pc + 1];
+            } else if (instruction.mode_a == RELATIVE) {
+                instruction.a = vm.tape[vm.tape[vm.pc + 1] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_a == POSITION);
+                instruction.a = vm.tape[vm.tape[vm.pc + 1]];
+            }
+
+            if (instruction.mode_b == IMMEDIATE) {
+                instruction.b = vm.tape[vm.pc + 2];
+            } else if (instruction.mode_b == RELATIVE) {
+                instruction.b = vm.tape[vm.tape[vm.pc + 2] + vm.relative_offset];
+            } else {
+                assert(instruction.mode_b == POSITION);
+                instruction.b = vm.tape[vm.tape[vm.pc + 2]];
+            }
+
+            instruction.c = -1; // not used
+            break;
+        case END:
+            instruction.offset = 1;
+            instruction.a = -1; // not used
+            instruction.b = -1; // not used
+            instruction.c = -1; // not used
+            break;
+        default:
+            assert(false);
+    }
+
+    return instruction;
+}
+
+void run_instruction_23(VM &vm, IntCode const &instruction) {
+    // if not a valid opcode
+    if (instruction.op_code != ADD && instruction.op_code != MULT &&
+        instruction.op_code != INPUT && instruction.op_code != OUTPUT &&
+        instruction.op_code != JUMP_FALSE && instruction.op_code != JUMP_TRUE &&
+        instruction.op_code != LESS_THAN && instruction.op_code != EQUALS && instruction.op_code != END &&
+        instruction.op_code != RELATIVE_ADJUST) {
+        std::cout << "Invalid op_code = " << instruction.op_code << std::endl;
+        std::cout << vm.tape[vm.pc] << "," << vm.tape[vm.pc + 1] << "," << vm.tape[vm.pc + 2] << "," << vm.tape[vm.pc + 3] << std::endl;
+
+        // program counter to the end and halt
+        vm.pc = vm.tape.size();
+        vm.halted = true;
+        return;
+    }
+
+    long result;
+    const long a = instruction.a;
+    const long b = instruction.b;
+    const long c = instruction.c;
+
+    // do the operation
+    switch (instruction.op_code) {
+        case ADD:
+            // add
+            result = a + b;
+            vm.tape[c] = result;
+            break;
+        case MULT:
+            // multiply
+            result = a * b;
+            vm.tape[c] = result;
+            break;
+        case INPUT:
+            // take input, if there is any
+            assert(!vm.inputs.empty());
+            vm.tape[a] = vm.inputs.front();
+            vm.inputs.pop_front();
+            break;
+        case OUTPUT:
+            // output pauses so that it can be retrieved
+            vm.output = a;
+            vm.paused = true;
+            break;
+        case JUMP_FALSE:
+            if (a == 0) {
+                vm.pc = b;
+                return;
+            }
+            break;
+        case JUMP_TRUE:
+            if (a != 0) {
+                vm.pc = b;
+                return;
+            }
+            break;
+        case LESS_THAN:
+            vm.tape[c] = a < b ? 1 : 0;
+            break;
+        case EQUALS:
+            vm.tape[c] = a == b ? 1 : 0;
+            break;
+        case RELATIVE_ADJUST:
+            vm.relative_offset += a;
+            break;
+        case END:
+            vm.halted = true;
+            vm.pc = vm.tape.size();
+            return;
+        default:
+            // should not be anything else
+            assert(false);
+    }
+
+    vm.pc += instruction.offset;
+
 
-    cout << "Nothing done here yet " << endl;
 }